@@ -17,6 +17,7 @@
 #include <vector>
 
 #include "../population/boundary/boundary.hpp"
+#include "../general/constexpr_func.hpp"
 #include "../general/memory_alignment.hpp"
 
 
@@ -34,6 +35,7 @@ class Continuum
     public:
         static constexpr unsigned int NM_ = 4; // number of macroscopic values: rho, ux, uy, uz
         static constexpr size_t MEM_SIZE_ = sizeof(T)*NZ*NY*NX*static_cast<size_t>(NM_); // size of array in byte
+        static constexpr unsigned int BRICK_SIZE_ = 16; // edge length of bricks in chunked export
 
         /// population allocated in heap
         T* const M_ = static_cast<T*>(aligned_alloc(CACHE_LINE, MEM_SIZE_));
@@ -70,6 +72,7 @@ class Continuum
         void Export(std::string const name, unsigned int const step) const;
         void ExportScalarVtk(unsigned int const m, std::string const name, unsigned int const step) const;
         void ExportVtk(unsigned int const step) const;
+        void ExportBricks(std::string const name, unsigned int const step) const;
 
         /// import time step from disk
         void Import(std::string const name, unsigned int const step);
@@ -78,5 +81,6 @@ class Continuum
 #include "continuum_indexing.hpp"
 #include "continuum_import.hpp"
 #include "continuum_export.hpp"
+#include "continuum_brick.hpp"
 
 #endif // CONTINUUM_HPP_INCLUDED
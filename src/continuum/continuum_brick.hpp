@@ -0,0 +1,464 @@
+#ifndef CONTINUUM_BRICK_HPP_INCLUDED
+#define CONTINUUM_BRICK_HPP_INCLUDED
+
+/**
+ * \file     continuum_brick.hpp
+ * \brief    Chunked and indexed export format for macroscopic values
+ *
+ * \mainpage The flat *.bin export has to be read in its entirety even if only a small part of the
+ *           domain is of interest. The brick format splits the domain into cubic bricks of fixed
+ *           size. Each brick holds all macroscopic values, one after another, and starts at a page
+ *           boundary so that reading a single value of a sub-volume through a memory map only
+ *           touches the pages that are actually needed.
+ *           All time steps of an export series are written to a common directory that contains an
+ *           index file listing the time steps and their corresponding brick files.
+ *
+ *           File layout: [header][brick offset index][padding][brick 0][brick 1]...
+ *           Brick layout: [m = 0: BRICK_SIZE^3 values, x fastest][m = 1]...[padding]
+*/
+
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <stdint.h>
+#include <string>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../general/constexpr_func.hpp"
+#include "../general/paths.hpp"
+
+
+/// size of a memory page: bricks are aligned to it
+#define BRICK_PAGE_SIZE    4096
+
+/// file identifier and version of the brick format
+#define BRICK_MAGIC        "LBTBRICK"
+#define BRICK_VERSION      1
+
+
+/**\struct brickHeader
+ * \brief  Plain header at the beginning of every brick file
+*/
+struct brickHeader
+{
+    char     magic[8];        ///< file identifier BRICK_MAGIC
+    uint32_t version;         ///< version of the format
+    uint32_t valueSize;       ///< size of a single value in bytes (4: float, 8: double)
+    uint32_t NX;              ///< domain resolution
+    uint32_t NY;
+    uint32_t NZ;
+    uint32_t NM;              ///< number of macroscopic values per cell
+    uint32_t brickSize;       ///< edge length of a brick in cells
+    uint32_t reserved;
+    uint64_t step;            ///< time step of the export
+    uint64_t numberOfBricks;  ///< total number of bricks
+    uint64_t brickBytes;      ///< size of a single brick including padding in bytes
+    uint64_t indexOffset;     ///< position of the brick offset index in the file
+};
+
+
+/**\fn        BrickExportDirectory
+ * \brief     Directory holding all time steps of a brick export series
+ *
+ * \param[in] name   name of the export series
+ * \return    path of the corresponding directory
+*/
+inline std::string BrickExportDirectory(std::string const& name)
+{
+    return OUTPUT_BIN_PATH + std::string("/") + name + std::string(".bricks");
+}
+
+
+/**\fn        ExportBricks
+ * \brief     Export macroscopic values at current time step to a brick file and register it in the
+ *            index of the corresponding export series. The bricks are filled in parallel through a
+ *            shared memory map of the output file.
+ *
+ * \param[in] name   the name of the export series
+ * \param[in] step   the current time step
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void Continuum<NX,NY,NZ,T>::ExportBricks(std::string const name, unsigned int const step) const
+{
+    struct stat info;
+
+    if (stat(OUTPUT_BIN_PATH.c_str(), &info) != 0 || !S_ISDIR(info.st_mode))
+    {
+        std::cerr << "Fatal error: Directory '" << OUTPUT_BIN_PATH << "' not found." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::string const directory = BrickExportDirectory(name);
+    if ((mkdir(directory.c_str(), 0755) != 0) && (errno != EEXIST))
+    {
+        std::cerr << "Fatal error: Could not create directory '" << directory << "'." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    /// layout of the file
+    constexpr size_t B  = BRICK_SIZE_;
+    constexpr size_t B3 = B*B*B;
+    constexpr size_t NUM_BRICKS_X = cef::ceil(static_cast<double>(NX) / B);
+    constexpr size_t NUM_BRICKS_Y = cef::ceil(static_cast<double>(NY) / B);
+    constexpr size_t NUM_BRICKS_Z = cef::ceil(static_cast<double>(NZ) / B);
+    constexpr size_t NUM_BRICKS   = NUM_BRICKS_X*NUM_BRICKS_Y*NUM_BRICKS_Z;
+
+    size_t const brickBytes  = BRICK_PAGE_SIZE*cef::ceil(static_cast<double>(NM_*B3*sizeof(T)) / BRICK_PAGE_SIZE);
+    size_t const indexOffset = sizeof(brickHeader);
+    size_t const dataOffset  = BRICK_PAGE_SIZE*cef::ceil(static_cast<double>(indexOffset + NUM_BRICKS*sizeof(uint64_t)) / BRICK_PAGE_SIZE);
+    size_t const fileSize    = dataOffset + NUM_BRICKS*brickBytes;
+
+    std::string const fileName = std::string("step_") + std::to_string(step) + std::string(".brk");
+    std::string const filePath = directory + std::string("/") + fileName;
+
+    int const fd = open(filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if ((fd < 0) || (ftruncate(fd, fileSize) != 0))
+    {
+        std::cerr << "Fatal error: Could not create brick file '" << filePath << "'." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    char* const file = static_cast<char*>(mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+    if (file == MAP_FAILED)
+    {
+        std::cerr << "Fatal error: Could not map brick file '" << filePath << "'." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    /// header and index
+    brickHeader header;
+    memset(&header, 0, sizeof(brickHeader));
+    memcpy(header.magic, BRICK_MAGIC, sizeof(header.magic));
+    header.version        = BRICK_VERSION;
+    header.valueSize      = sizeof(T);
+    header.NX             = NX;
+    header.NY             = NY;
+    header.NZ             = NZ;
+    header.NM             = NM_;
+    header.brickSize      = B;
+    header.step           = step;
+    header.numberOfBricks = NUM_BRICKS;
+    header.brickBytes     = brickBytes;
+    header.indexOffset    = indexOffset;
+    memcpy(file, &header, sizeof(brickHeader));
+
+    uint64_t* const index = reinterpret_cast<uint64_t*>(file + indexOffset);
+    for(size_t brick = 0; brick < NUM_BRICKS; ++brick)
+    {
+        index[brick] = dataOffset + brick*brickBytes;
+    }
+
+    /// bricks: padded regions outside the domain remain zero
+    #pragma omp parallel for default(none) shared(file,index) schedule(static,1)
+    for(size_t brick = 0; brick < NUM_BRICKS; ++brick)
+    {
+        T* const values = reinterpret_cast<T*>(file + index[brick]);
+
+        size_t const x_start = B*(brick % NUM_BRICKS_X);
+        size_t const y_start = B*((brick / NUM_BRICKS_X) % NUM_BRICKS_Y);
+        size_t const z_start = B*(brick / (NUM_BRICKS_X*NUM_BRICKS_Y));
+        size_t const   x_end = std::min(x_start + B, static_cast<size_t>(NX));
+        size_t const   y_end = std::min(y_start + B, static_cast<size_t>(NY));
+        size_t const   z_end = std::min(z_start + B, static_cast<size_t>(NZ));
+
+        for(unsigned int m = 0; m < NM_; ++m)
+        {
+            for(size_t z = z_start; z < z_end; ++z)
+            {
+                for(size_t y = y_start; y < y_end; ++y)
+                {
+                    for(size_t x = x_start; x < x_end; ++x)
+                    {
+                        values[m*B3 + ((z - z_start)*B + (y - y_start))*B + (x - x_start)] = M_[SpatialToLinear(x, y, z, m)];
+                    }
+                }
+            }
+        }
+    }
+
+    munmap(file, fileSize);
+    close(fd);
+
+    /// register time step in the index of the series
+    std::string const indexName = directory + std::string("/index.txt");
+    FILE* const indexFile = fopen(indexName.c_str(), "a");
+    if (indexFile == nullptr)
+    {
+        std::cerr << "Fatal error: Could not open index of brick series '" << indexName << "'." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    fprintf(indexFile, "%u %s\n", step, fileName.c_str());
+    fclose(indexFile);
+}
+
+
+/**\class  BrickReader
+ * \brief  Read-only access to a single brick file through a memory map. Only the pages holding the
+ *         requested part of the domain are loaded from disk.
+ *
+ * \tparam T   floating data type of the stored values
+*/
+template <typename T = double>
+class BrickReader
+{
+    private:
+        int         fd_     = -1;
+        size_t      size_   = 0;
+        char const* file_   = nullptr;
+        brickHeader header_;
+
+        size_t numBricksX_ = 0;
+        size_t numBricksY_ = 0;
+
+    public:
+        /**\brief     Class constructor: open and map brick file
+         *
+         * \param[in] filePath   path of the brick file
+        */
+        BrickReader(std::string const& filePath)
+        {
+            struct stat info;
+
+            fd_ = open(filePath.c_str(), O_RDONLY);
+            if ((fd_ < 0) || (fstat(fd_, &info) != 0) || (static_cast<size_t>(info.st_size) < sizeof(brickHeader)))
+            {
+                std::cerr << "Fatal error: Could not open brick file '" << filePath << "'." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            size_ = info.st_size;
+
+            void* const file = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+            if (file == MAP_FAILED)
+            {
+                std::cerr << "Fatal error: Could not map brick file '" << filePath << "'." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            file_ = static_cast<char const*>(file);
+            madvise(file, size_, MADV_RANDOM);
+
+            memcpy(&header_, file_, sizeof(brickHeader));
+            if ((memcmp(header_.magic, BRICK_MAGIC, sizeof(header_.magic)) != 0) || (header_.version != BRICK_VERSION) ||
+                (header_.valueSize != sizeof(T)))
+            {
+                std::cerr << "Fatal error: '" << filePath << "' is not a compatible brick file." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+
+            if ((header_.brickSize == 0) || (header_.NX == 0) || (header_.NY == 0) || (header_.NZ == 0) || (header_.NM == 0))
+            {
+                std::cerr << "Fatal error: Brick file '" << filePath << "' has an invalid domain." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+
+            numBricksX_ = cef::ceil(static_cast<double>(header_.NX) / header_.brickSize);
+            numBricksY_ = cef::ceil(static_cast<double>(header_.NY) / header_.brickSize);
+            size_t const numBricksZ = cef::ceil(static_cast<double>(header_.NZ) / header_.brickSize);
+
+            // a truncated or corrupt file must not be accessed through the map (SIGBUS)
+            size_t const brickCapacity = header_.brickBytes/sizeof(T)/header_.brickSize/header_.brickSize/header_.brickSize;
+            if ((header_.numberOfBricks != numBricksX_*numBricksY_*numBricksZ) || (brickCapacity < header_.NM) ||
+                (header_.indexOffset < sizeof(brickHeader)) || (header_.indexOffset > size_) ||
+                (header_.indexOffset % sizeof(uint64_t) != 0) ||
+                (header_.numberOfBricks > (size_ - header_.indexOffset)/sizeof(uint64_t)))
+            {
+                std::cerr << "Fatal error: Brick file '" << filePath << "' is truncated or corrupt." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+
+            uint64_t const* const index = reinterpret_cast<uint64_t const*>(file_ + header_.indexOffset);
+            for(size_t brick = 0; brick < header_.numberOfBricks; ++brick)
+            {
+                if ((index[brick] > size_) || (header_.brickBytes > size_ - index[brick]))
+                {
+                    std::cerr << "Fatal error: Brick file '" << filePath << "' is truncated or corrupt." << std::endl;
+                    exit(EXIT_FAILURE);
+                }
+            }
+        }
+
+        BrickReader(BrickReader const&) = delete;
+        BrickReader& operator= (BrickReader const&) = delete;
+
+        /**\brief Class destructor
+        */
+        ~BrickReader()
+        {
+            munmap(const_cast<char*>(file_), size_);
+            close(fd_);
+        }
+
+        /// domain properties
+        unsigned int GetNX()   const { return header_.NX;   }
+        unsigned int GetNY()   const { return header_.NY;   }
+        unsigned int GetNZ()   const { return header_.NZ;   }
+        unsigned int GetNM()   const { return header_.NM;   }
+        size_t       GetStep() const { return header_.step; }
+
+        /**\fn         ReadSubVolume
+         * \brief      Copy a macroscopic value of an arbitrary box [x_0,x_1) x [y_0,y_1) x [z_0,z_1)
+         *             to a contiguous array (x fastest)
+         *
+         * \param[in]  m     macroscopic value (0: density, 1-3: ux, uy, uz)
+         * \param[in]  x_0   first cell of the box in x-direction
+         * \param[in]  y_0   first cell of the box in y-direction
+         * \param[in]  z_0   first cell of the box in z-direction
+         * \param[in]  x_1   cell behind the last cell of the box in x-direction
+         * \param[in]  y_1   cell behind the last cell of the box in y-direction
+         * \param[in]  z_1   cell behind the last cell of the box in z-direction
+         * \param[out] out   array of size (x_1-x_0)*(y_1-y_0)*(z_1-z_0) the values are written to
+        */
+        void ReadSubVolume(unsigned int const m,
+                           unsigned int const x_0, unsigned int const y_0, unsigned int const z_0,
+                           unsigned int const x_1, unsigned int const y_1, unsigned int const z_1,
+                           T* const out) const
+        {
+            if ((m >= header_.NM) || (x_0 >= x_1) || (y_0 >= y_1) || (z_0 >= z_1) ||
+                (x_1 > header_.NX) || (y_1 > header_.NY) || (z_1 > header_.NZ))
+            {
+                std::cerr << "Error: Requested sub-volume is outside of the domain." << std::endl;
+                return;
+            }
+
+            size_t const B  = header_.brickSize;
+            size_t const B3 = B*B*B;
+            size_t const nx = x_1 - x_0;
+            size_t const ny = y_1 - y_0;
+            uint64_t const* const index = reinterpret_cast<uint64_t const*>(file_ + header_.indexOffset);
+
+            size_t const bx_0 = x_0/B;
+            size_t const by_0 = y_0/B;
+            size_t const bz_0 = z_0/B;
+            size_t const bx_n = (x_1 - 1)/B - bx_0 + 1;
+            size_t const by_n = (y_1 - 1)/B - by_0 + 1;
+            size_t const bz_n = (z_1 - 1)/B - bz_0 + 1;
+
+            /// announce all required pages first so that the kernel can read them ahead
+            for(size_t bz = bz_0; bz < bz_0 + bz_n; ++bz)
+            {
+                for(size_t by = by_0; by < by_0 + by_n; ++by)
+                {
+                    for(size_t bx = bx_0; bx < bx_0 + bx_n; ++bx)
+                    {
+                        size_t const brick  = (bz*numBricksY_ + by)*numBricksX_ + bx;
+                        size_t const offset = index[brick] + m*B3*sizeof(T);
+                        size_t const page   = offset - offset % BRICK_PAGE_SIZE;
+                        madvise(const_cast<char*>(file_) + page, offset - page + B3*sizeof(T), MADV_WILLNEED);
+                    }
+                }
+            }
+
+            #pragma omp parallel for default(none) shared(index,out) firstprivate(m,x_0,y_0,z_0,x_1,y_1,z_1,B,B3,nx,ny,bx_0,by_0,bz_0,bx_n,by_n,bz_n) schedule(dynamic,1)
+            for(size_t i = 0; i < bx_n*by_n*bz_n; ++i)
+            {
+                size_t const bx = bx_0 + i % bx_n;
+                size_t const by = by_0 + (i / bx_n) % by_n;
+                size_t const bz = bz_0 + i / (bx_n*by_n);
+                size_t const brick = (bz*numBricksY_ + by)*numBricksX_ + bx;
+                T const* const values = reinterpret_cast<T const*>(file_ + index[brick]) + m*B3;
+
+                size_t const xs = std::max(bx*B, static_cast<size_t>(x_0));
+                size_t const ys = std::max(by*B, static_cast<size_t>(y_0));
+                size_t const zs = std::max(bz*B, static_cast<size_t>(z_0));
+                size_t const xe = std::min((bx + 1)*B, static_cast<size_t>(x_1));
+                size_t const ye = std::min((by + 1)*B, static_cast<size_t>(y_1));
+                size_t const ze = std::min((bz + 1)*B, static_cast<size_t>(z_1));
+
+                for(size_t z = zs; z < ze; ++z)
+                {
+                    for(size_t y = ys; y < ye; ++y)
+                    {
+                        memcpy(&out[((z - z_0)*ny + (y - y_0))*nx + (xs - x_0)],
+                               &values[((z - bz*B)*B + (y - by*B))*B + (xs - bx*B)],
+                               (xe - xs)*sizeof(T));
+                    }
+                }
+            }
+        }
+
+        /**\fn         ReadField
+         * \brief      Copy a macroscopic value of the entire domain to a contiguous array (x fastest)
+         *
+         * \param[in]  m     macroscopic value (0: density, 1-3: ux, uy, uz)
+         * \param[out] out   array of size NX*NY*NZ the values are written to
+        */
+        void ReadField(unsigned int const m, T* const out) const
+        {
+            ReadSubVolume(m, 0, 0, 0, header_.NX, header_.NY, header_.NZ, out);
+        }
+};
+
+
+/**\class  BrickSeries
+ * \brief  Index of all time steps of a brick export series
+*/
+class BrickSeries
+{
+    private:
+        std::string               directory_;
+        std::vector<unsigned int> steps_;
+        std::vector<std::string>  files_;
+
+    public:
+        /**\brief     Class constructor: read index of export series
+         *
+         * \param[in] name   the name of the export series
+        */
+        BrickSeries(std::string const& name):
+            directory_(BrickExportDirectory(name)), steps_(), files_()
+        {
+            std::ifstream indexFile(directory_ + std::string("/index.txt"));
+            if (indexFile.is_open() == false)
+            {
+                std::cerr << "Fatal error: Brick series '" << name << "' not found." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+
+            unsigned int step = 0;
+            std::string  file;
+            while (indexFile >> step >> file)
+            {
+                steps_.push_back(step);
+                files_.push_back(file);
+            }
+        }
+
+        /**\fn     GetSteps
+         * \brief  Time steps contained in the series
+         *
+         * \return Vector holding all time steps in the order they were exported
+        */
+        std::vector<unsigned int> const& GetSteps() const
+        {
+            return steps_;
+        }
+
+        /**\fn        GetFile
+         * \brief     Path of the brick file belonging to a certain time step
+         *
+         * \param[in] step   the time step of interest
+         * \return    Path of the brick file, that can be opened with a BrickReader
+        */
+        std::string GetFile(unsigned int const step) const
+        {
+            for(size_t i = steps_.size(); i > 0; --i)
+            {
+                if (steps_[i-1] == step)
+                {
+                    return directory_ + std::string("/") + files_[i-1];
+                }
+            }
+
+            std::cerr << "Fatal error: Time step " << step << " not found in brick series." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+};
+
+#endif // CONTINUUM_BRICK_HPP_INCLUDED
@@ -0,0 +1,131 @@
+#ifndef CONTINUUM_BRICK_UNIT_TEST_HPP_INCLUDED
+#define CONTINUUM_BRICK_UNIT_TEST_HPP_INCLUDED
+
+/**
+ * \file     continuum_brick_unit_test.hpp
+ * \mainpage Unit test for the chunked brick export: round trip and rejection of truncated files
+*/
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "continuum.hpp"
+
+
+/**\fn     UnitTestBricks
+ * \brief  Export a domain that is not a multiple of the brick size, read the entire field and a
+ *         sub-volume crossing brick boundaries back and compare them to the original values. A
+ *         truncated copy of the file has to be rejected with a fatal error instead of a bus error.
+ *
+ * \return EXIT_SUCCESS if the test passed, else EXIT_FAILURE
+*/
+inline int UnitTestBricks()
+{
+    constexpr unsigned int NX = 20;
+    constexpr unsigned int NY = 17;
+    constexpr unsigned int NZ = 9;
+    std::string const name = "unit_test";
+
+    Continuum<NX,NY,NZ,double> Macro;
+    for(unsigned int z = 0; z < NZ; ++z)
+    {
+        for(unsigned int y = 0; y < NY; ++y)
+        {
+            for(unsigned int x = 0; x < NX; ++x)
+            {
+                for(unsigned int m = 0; m < Macro.NM_; ++m)
+                {
+                    Macro(x,y,z,m) = 1000.0*m + ((z*NY + y)*NX + x);
+                }
+            }
+        }
+    }
+    Macro.ExportBricks(name, 7);
+
+    std::string const fileName = BrickSeries(name).GetFile(7);
+    int result = EXIT_SUCCESS;
+    {
+        BrickReader<double> const Reader(fileName);
+
+        std::vector<double> field(NX*NY*NZ);
+        for(unsigned int m = 0; m < Macro.NM_; ++m)
+        {
+            Reader.ReadField(m, field.data());
+            for(unsigned int z = 0; z < NZ; ++z)
+            {
+                for(unsigned int y = 0; y < NY; ++y)
+                {
+                    for(unsigned int x = 0; x < NX; ++x)
+                    {
+                        if (std::abs(field[(z*NY + y)*NX + x] - Macro(x,y,z,m)) > 0.0)
+                        {
+                            result = EXIT_FAILURE;
+                        }
+                    }
+                }
+            }
+        }
+
+        // box [3,19) x [15,17) x [2,5) crosses the bricks in x- and y-direction
+        std::vector<double> box(16*2*3);
+        Reader.ReadSubVolume(2, 3, 15, 2, 19, 17, 5, box.data());
+        for(unsigned int z = 2; z < 5; ++z)
+        {
+            for(unsigned int y = 15; y < 17; ++y)
+            {
+                for(unsigned int x = 3; x < 19; ++x)
+                {
+                    if (std::abs(box[((z - 2)*2 + (y - 15))*16 + (x - 3)] - Macro(x,y,z,2)) > 0.0)
+                    {
+                        result = EXIT_FAILURE;
+                    }
+                }
+            }
+        }
+    }
+    if (result != EXIT_SUCCESS)
+    {
+        std::cerr << "Error: Brick export does not reproduce the exported values." << std::endl;
+    }
+
+    // truncated copy: the reader has to exit with a fatal error in a child process
+    std::string const truncatedName = fileName + ".truncated";
+    {
+        std::ifstream source(fileName, std::ios::binary);
+        std::vector<char> bytes(4096 + 100);
+        source.read(bytes.data(), bytes.size());
+        std::ofstream(truncatedName, std::ios::binary).write(bytes.data(), bytes.size());
+    }
+
+    pid_t const child = fork();
+    if (child == 0)
+    {
+        BrickReader<double> const Reader(truncatedName);
+        std::vector<double> field(NX*NY*NZ);
+        Reader.ReadField(3, field.data());
+        _exit(EXIT_SUCCESS);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    if ((WIFEXITED(status) == false) || (WEXITSTATUS(status) != EXIT_FAILURE))
+    {
+        std::cerr << "Error: Truncated brick file was not rejected." << std::endl;
+        result = EXIT_FAILURE;
+    }
+
+    remove(truncatedName.c_str());
+    remove(fileName.c_str());
+    remove((BrickExportDirectory(name) + "/index.txt").c_str());
+    rmdir(BrickExportDirectory(name).c_str());
+
+    return result;
+}
+
+#endif // CONTINUUM_BRICK_UNIT_TEST_HPP_INCLUDED
@@ -67,7 +67,7 @@ void Continuum<NX,NY,NZ,T>::Export(std::string const name, unsigned int const st
  * \brief     Export arbitrary scalar at current time step to a *.vtk-file that can then be read
  *            by visualisation applications like ParaView.
  * \warning   *.vtk export is comparably slow! Better export to .bin-files and then convert them
- *            to *.vtk-files with the external converter app afterwards.
+ *            to *.vti-files with the converter ('--convert') afterwards.
  *
  * \param[in] name   the export file name of the scalar
  * \param[in] step   the current time step that will be used for the name
@@ -136,7 +136,7 @@ void Continuum<NX,NY,NZ,T>::ExportScalarVtk(unsigned int const m, std::string co
  * \brief     Export velocity and density at current time step to a *.vtk-file that can then be
  *            read by visualisation applications like ParaView.
  * \warning   *.vtk export is comparably slow! Better export to .bin-files and then convert them
- *            to *.vtk-files with the external converter app afterwards.
+ *            to *.vti-files with the converter ('--convert') afterwards.
  *
  * \param[in] step   the current time step that will be used for the name
 */
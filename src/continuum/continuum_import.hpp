@@ -10,12 +10,18 @@
 #include <fstream>
 #include <sstream>
 #include <string.h>
+#include <sys/stat.h>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
 
 #include "../general/paths.hpp"
 
 
 /**\fn         Import
- * \brief      Import macroscopic values from *.bin-file
+ * \brief      Import macroscopic values from *.bin-file. Files exported with a different
+ *             floating precision are converted.
  *
  * \param[in]  name   the import file name holding the macroscopic quantities
  * \param[in]  step   the current time step that will be used for the name
@@ -25,15 +31,41 @@ void Continuum<NX,NY,NZ,T>::Import(std::string const name, unsigned int const st
 {
     std::string const fileName = OUTPUT_BIN_PATH + std::string("/") + name + std::string("_") + std::to_string(step) + std::string(".bin");
 
-    if(fopen(fileName.c_str(), "rb+") != nullptr)
+    constexpr size_t VALUES = static_cast<size_t>(NX)*NY*NZ*NM_;
+
+    FILE* const importFile = fopen(fileName.c_str(), "rb");
+    if (importFile == nullptr)
     {
-        FILE * const importFile = fopen(fileName.c_str(), "rb+");
-        fread(M_, 1, MEM_SIZE_, importFile);
-        fclose(importFile);
+        std::cerr << "Fatal error: Could not import macroscopic values from disk." << std::endl;
+        exit(EXIT_FAILURE);
     }
-    else
+
+    /// precision deduced from file size
+    struct stat info;
+    size_t const size = (fstat(fileno(importFile), &info) == 0) ? info.st_size : 0;
+
+    bool success = false;
+    if (size == MEM_SIZE_)
     {
-        std::cerr << "Fatal error: Could not import macroscopic values from disk." << std::endl;
+        success = (fread(M_, 1, MEM_SIZE_, importFile) == MEM_SIZE_);
+    }
+    else if ((size == VALUES*sizeof(float)) || (size == VALUES*sizeof(double)))
+    {
+        std::vector<char> buffer(size);
+        success = (fread(buffer.data(), 1, size, importFile) == size);
+
+        #pragma omp parallel for default(none) shared(buffer,size,VALUES) schedule(static)
+        for(size_t i = 0; i < VALUES; ++i)
+        {
+            M_[i] = (size == VALUES*sizeof(float)) ? static_cast<T>(reinterpret_cast<float const*>(buffer.data())[i])
+                                                   : static_cast<T>(reinterpret_cast<double const*>(buffer.data())[i]);
+        }
+    }
+    fclose(importFile);
+
+    if (success == false)
+    {
+        std::cerr << "Fatal error: Macroscopic values '" << fileName << "' do not match the resolution." << std::endl;
         exit(EXIT_FAILURE);
     }
 }
@@ -21,7 +21,7 @@ template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
 inline size_t __attribute__((always_inline)) Continuum<NX,NY,NZ,T>::SpatialToLinear(unsigned int const x, unsigned int const y, unsigned int const z,
                                                                                     unsigned int const m) const
 {
-    return ((z*NY + y)*NX + x)*NM_ + m;
+    return ((static_cast<size_t>(z)*NY + y)*NX + x)*NM_ + m;
 }
 
 
@@ -37,7 +37,7 @@ template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
 void Continuum<NX,NY,NZ,T>::LinearToSpatial(unsigned int& x, unsigned int& y, unsigned int& z,
                                             unsigned int& m, size_t const index) const
 {
-    size_t factor = NM_*NX*NY;
+    size_t factor = static_cast<size_t>(NM_)*NX*NY;
     size_t rest   = index%factor;
 
     z      = index/factor;
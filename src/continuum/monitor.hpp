@@ -0,0 +1,265 @@
+#ifndef MONITOR_HPP_INCLUDED
+#define MONITOR_HPP_INCLUDED
+
+/**
+ * \file     monitor.hpp
+ * \mainpage Global diagnostics and steady-state detection for early termination
+ *
+ * \note     If a monitor is handed to the collide-stream kernels of a sampled time step, they add
+ *           mass, kinetic energy, maximum velocity and the relative L2 change of the velocity since
+ *           the last check to per-thread partial sums while the cell is held in registers, and keep a
+ *           copy of its velocity. No macroscopic values have to be saved for a check. Only the
+ *           enstrophy needs the velocity of the neighbours: it is evaluated afterwards by a single
+ *           stencil over the velocity copy (three values per cell instead of the populations).
+ *           The simulation is considered converged once the relative change falls below a given
+ *           tolerance. Solid cells are skipped by the kernels and do not contribute.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../general/memory_alignment.hpp"
+#include "../general/parallelism.hpp"
+#include "../general/paths.hpp"
+
+
+/**\class  Monitor
+ * \brief  Evaluates global diagnostics accumulated by the kernels and detects a steady state
+ *
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+ * \tparam T    floating data type used for simulation
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T = double>
+class Monitor
+{
+    public:
+        static constexpr size_t MEM_SIZE_ = sizeof(T)*NZ*NY*NX*static_cast<size_t>(3); // size of velocity array in byte
+
+        /// velocity of the last check allocated in heap (solid cells remain zero)
+        T* const U_ = static_cast<T*>(aligned_alloc(CACHE_LINE, MEM_SIZE_));
+
+        size_t const INTERVAL_;   ///< number of time steps between two checks
+        double const TOLERANCE_;  ///< relative L2 change of the velocity below which the simulation is converged
+
+        /// global diagnostics of the last check
+        double mass_;
+        double kinetic_;
+        double enstrophy_;
+        double maxVelocity_;
+        double change_;
+
+        /**\brief     Class constructor
+         *
+         * \param[in] interval    number of time steps between two checks
+         * \param[in] tolerance   relative L2 change of the velocity between two checks below which the
+         *                        simulation is converged (0: never)
+         * \param[in] name        name of the diagnostics file (default = "monitor")
+        */
+        Monitor(size_t const interval, double const tolerance, std::string const& name = "monitor"):
+            INTERVAL_(std::max(interval, static_cast<size_t>(1))), TOLERANCE_(tolerance),
+            mass_(0.0), kinetic_(0.0), enstrophy_(0.0), maxVelocity_(0.0), change_(1.0),
+            checks_(0), partials_(), file_(nullptr), name_(name)
+        {
+            if (U_ == nullptr)
+            {
+                std::cerr << "Fatal error: Monitor could not be allocated." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+
+            T* const U = U_;
+            #pragma omp parallel for default(none) firstprivate(U) schedule(static)
+            for(size_t i = 0; i < static_cast<size_t>(NZ)*NY*NX*3; ++i)
+            {
+                U[i] = 0.0;
+            }
+        }
+
+        Monitor(Monitor const&) = delete;
+        Monitor& operator= (Monitor const&) = delete;
+
+        /**\brief Class destructor
+        */
+        ~Monitor()
+        {
+            if (file_ != nullptr)
+            {
+                fclose(file_);
+            }
+            free(U_);
+        }
+
+        /**\fn        Sample
+         * \brief     Determine if the diagnostics have to be evaluated after a given time step and
+         *            reset the partial sums
+         *
+         * \param[in] step   number of completed time steps after the sampled time step
+         * \return    Pointer to the monitor if a check is due, else nullptr. The return value is
+         *            handed to the collide-stream kernels of the sampled time step.
+        */
+        Monitor* Sample(size_t const step)
+        {
+            if (step % INTERVAL_ != 0)
+            {
+                return nullptr;
+            }
+
+            partials_.assign(static_cast<size_t>(std::max(parallel::ThreadsMax(), 1)), partial());
+            return this;
+        }
+
+        /**\fn        Accumulate
+         * \brief     Add macroscopic values of a cell to the partial sums of a part of the sweep
+         * \warning   Inline function! Called from within the kernels.
+         *
+         * \param[in] part   part of the sweep (one per thread) processing the cell
+         * \param[in] x      x coordinate of cell
+         * \param[in] y      y coordinate of cell
+         * \param[in] z      z coordinate of cell
+         * \param[in] rho    density
+         * \param[in] u      velocity in x-direction
+         * \param[in] v      velocity in y-direction
+         * \param[in] w      velocity in z-direction
+        */
+        inline void __attribute__((always_inline)) Accumulate(unsigned int const part, unsigned int const x, unsigned int const y,
+                                                              unsigned int const z, T const rho, T const u, T const v, T const w)
+        {
+            partial& s = partials_[part];
+            T* const previous = U_ + ((static_cast<size_t>(z)*NY + y)*NX + x)*3;
+
+            double const uu = static_cast<double>(u)*u + static_cast<double>(v)*v + static_cast<double>(w)*w;
+            double const du = u - previous[0];
+            double const dv = v - previous[1];
+            double const dw = w - previous[2];
+
+            s.mass        += rho;
+            s.kinetic     += 0.5*rho*uu;
+            s.maxVelocity  = std::max(s.maxVelocity, uu);
+            s.difference  += du*du + dv*dv + dw*dw;
+            s.norm        += uu;
+
+            previous[0] = u;
+            previous[1] = v;
+            previous[2] = w;
+        }
+
+        /**\fn        Update
+         * \brief     Combine the partial sums of the sampled time step, evaluate the enstrophy from
+         *            the velocity copy, append the diagnostics to the diagnostics file and check for
+         *            convergence
+         *
+         * \param[in] step   number of completed time steps
+         * \return    True if the simulation has converged and may be terminated
+        */
+        bool Update(size_t const step)
+        {
+            double mass        = 0.0;
+            double kinetic     = 0.0;
+            double maxVelocity = 0.0;
+            double difference  = 0.0;
+            double norm        = 0.0;
+            for(auto const& s: partials_)
+            {
+                mass       += s.mass;
+                kinetic    += s.kinetic;
+                maxVelocity = std::max(maxVelocity, s.maxVelocity);
+                difference += s.difference;
+                norm       += s.norm;
+            }
+
+            double enstrophy = 0.0;
+            T const* const U = U_;
+
+            #pragma omp parallel for collapse(2) default(none) firstprivate(U) reduction(+:enstrophy) schedule(static)
+            for(unsigned int z = 0; z < NZ; ++z)
+            {
+                for(unsigned int y = 0; y < NY; ++y)
+                {
+                    unsigned int const z_n[2] = { (NZ + z - 1) % NZ, (z + 1) % NZ };
+                    unsigned int const y_n[2] = { (NY + y - 1) % NY, (y + 1) % NY };
+
+                    for(unsigned int x = 0; x < NX; ++x)
+                    {
+                        unsigned int const x_n[2] = { (NX + x - 1) % NX, (x + 1) % NX };
+
+                        auto const vel = [U](unsigned int const x_c, unsigned int const y_c, unsigned int const z_c, unsigned int const m) -> double
+                        {
+                            return U[((static_cast<size_t>(z_c)*NY + y_c)*NX + x_c)*3 + m];
+                        };
+
+                        /// vorticity by central differences
+                        double const omega_x = 0.5*(vel(x, y_n[1], z, 2) - vel(x, y_n[0], z, 2)) - 0.5*(vel(x, y, z_n[1], 1) - vel(x, y, z_n[0], 1));
+                        double const omega_y = 0.5*(vel(x, y, z_n[1], 0) - vel(x, y, z_n[0], 0)) - 0.5*(vel(x_n[1], y, z, 2) - vel(x_n[0], y, z, 2));
+                        double const omega_z = 0.5*(vel(x_n[1], y, z, 1) - vel(x_n[0], y, z, 1)) - 0.5*(vel(x, y_n[1], z, 0) - vel(x, y_n[0], z, 0));
+                        enstrophy += 0.5*(omega_x*omega_x + omega_y*omega_y + omega_z*omega_z);
+                    }
+                }
+            }
+
+            mass_        = mass;
+            kinetic_     = kinetic;
+            enstrophy_   = enstrophy;
+            maxVelocity_ = std::sqrt(maxVelocity);
+            change_      = ((checks_ > 0) && (norm > 0.0)) ? std::sqrt(difference/norm) : 1.0;
+            ++checks_;
+
+            Write(step);
+
+            return (change_ < TOLERANCE_);
+        }
+
+    private:
+        /**\struct partial
+         * \brief  Partial sums of a part of the sweep, padded to a cache line against false sharing
+        */
+        struct alignas(CACHE_LINE) partial
+        {
+            double mass        = 0.0;
+            double kinetic     = 0.0;
+            double maxVelocity = 0.0;
+            double difference  = 0.0;
+            double norm        = 0.0;
+        };
+
+        size_t               checks_;   ///< number of checks performed
+        std::vector<partial> partials_; ///< partial sums of the sampled time step (one per part)
+        FILE*                file_;     ///< diagnostics output file (opened with the first check)
+        std::string const    name_;     ///< name of the diagnostics file
+
+        /**\fn        Write
+         * \brief     Append the diagnostics of the last check to OUTPUT_BIN_PATH/<name>.txt
+         *
+         * \param[in] step   number of completed time steps
+        */
+        void Write(size_t const step)
+        {
+            if (file_ == nullptr)
+            {
+                struct stat info;
+                std::string const fileName = OUTPUT_BIN_PATH + std::string("/") + name_ + std::string(".txt");
+
+                if ((stat(OUTPUT_BIN_PATH.c_str(), &info) != 0) || !S_ISDIR(info.st_mode) ||
+                    ((file_ = fopen(fileName.c_str(), "w")) == nullptr))
+                {
+                    std::cerr << "Fatal error: Could not create '" << fileName << "'." << std::endl;
+                    exit(EXIT_FAILURE);
+                }
+                fprintf(file_, "# step mass kinetic_energy enstrophy max_velocity relative_change\n");
+            }
+
+            fprintf(file_, "%zu %.9e %.9e %.9e %.9e %.9e\n", step, mass_, kinetic_, enstrophy_, maxVelocity_, change_);
+            fflush(file_);
+        }
+};
+
+#endif // MONITOR_HPP_INCLUDED
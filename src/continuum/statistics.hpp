@@ -0,0 +1,261 @@
+#ifndef STATISTICS_HPP_INCLUDED
+#define STATISTICS_HPP_INCLUDED
+
+/**
+ * \file     statistics.hpp
+ * \mainpage Class for turbulence statistics accumulated inside the collide-stream kernels
+ *
+ * \note     The kernels already hold density and velocities of every cell in registers. If a
+ *           statistics object is handed to a kernel, it adds them together with their products to
+ *           running sums, so mean values, RMS values and Reynolds stresses can be evaluated at the
+ *           end of the simulation without any intermediate exports:
+ *           <u'v'> = <uv> - <u><v>
+ *           The sums are always accumulated in double precision to limit cancellation errors.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <sys/stat.h>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../general/memory_alignment.hpp"
+#include "../general/paths.hpp"
+
+
+/**\class  Statistics
+ * \brief  Running sums of macroscopic values for time averages and Reynolds stresses
+ *
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+ * \tparam T    floating data type used for simulation
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T = double>
+class Statistics
+{
+    public:
+        /// accumulated values per cell: rho, u, v, w, uu, vv, ww, uv, uw, vw
+        static constexpr unsigned int NS_ = 10;
+        static constexpr size_t MEM_SIZE_ = sizeof(double)*NZ*NY*NX*static_cast<size_t>(NS_);
+
+        /// squared lattice speed of sound of the standard lattices for the pressure p = cs^2 rho
+        static constexpr double CS2_ = 1.0/3.0;
+
+        /// sums allocated in heap
+        double* const S_ = static_cast<double*>(aligned_alloc(CACHE_LINE, MEM_SIZE_));
+
+        size_t const START_;    ///< first time step that is sampled
+        size_t const INTERVAL_; ///< number of time steps between two samples
+        size_t       samples_;  ///< number of accumulated samples
+
+        /**\brief     Class constructor
+         *
+         * \param[in] start      first time step that is sampled (e.g. after initial transient)
+         * \param[in] interval   number of time steps between two samples (default = 1)
+        */
+        Statistics(size_t const start, size_t const interval = 1):
+            START_(start), INTERVAL_(std::max(interval, static_cast<size_t>(1))), samples_(0)
+        {
+            if (S_ == nullptr)
+            {
+                std::cerr << "Fatal error: Statistics could not be allocated." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+
+            double* const S = S_;
+            #pragma omp parallel for default(none) firstprivate(S) schedule(static)
+            for(size_t i = 0; i < static_cast<size_t>(NZ)*NY*NX*NS_; ++i)
+            {
+                S[i] = 0.0;
+            }
+        }
+
+        Statistics(Statistics const&) = delete;
+        Statistics& operator= (Statistics const&) = delete;
+
+        /**\brief Class destructor
+        */
+        ~Statistics()
+        {
+            free(S_);
+        }
+
+        /**\fn        Sample
+         * \brief     Determine if a time step is sampled and count it
+         *
+         * \param[in] step   current time step
+         * \return    Pointer to the statistics if the step should be sampled, else nullptr. The
+         *            return value is handed to the collide-stream kernels.
+        */
+        Statistics* Sample(size_t const step)
+        {
+            if ((step < START_) || ((step - START_) % INTERVAL_ != 0))
+            {
+                return nullptr;
+            }
+
+            ++samples_;
+            return this;
+        }
+
+        /**\fn        Accumulate
+         * \brief     Add macroscopic values of a cell to the running sums
+         * \warning   Inline function! Called from within the kernels.
+         *
+         * \param[in] x     x coordinate of cell
+         * \param[in] y     y coordinate of cell
+         * \param[in] z     z coordinate of cell
+         * \param[in] rho   density
+         * \param[in] u     velocity in x-direction
+         * \param[in] v     velocity in y-direction
+         * \param[in] w     velocity in z-direction
+        */
+        inline void __attribute__((always_inline)) Accumulate(unsigned int const x, unsigned int const y, unsigned int const z,
+                                                              T const rho, T const u, T const v, T const w)
+        {
+            double* const s = S_ + ((static_cast<size_t>(z)*NY + y)*NX + x)*NS_;
+            double const ud = u;
+            double const vd = v;
+            double const wd = w;
+
+            s[0] += rho;
+            s[1] += ud;
+            s[2] += vd;
+            s[3] += wd;
+            s[4] += ud*ud;
+            s[5] += vd*vd;
+            s[6] += wd*wd;
+            s[7] += ud*vd;
+            s[8] += ud*wd;
+            s[9] += vd*wd;
+        }
+
+        /**\fn        GetMean
+         * \brief     Time average of an accumulated value of a cell
+         *
+         * \param[in] x   x coordinate of cell
+         * \param[in] y   y coordinate of cell
+         * \param[in] z   z coordinate of cell
+         * \param[in] s   accumulated value: rho, u, v, w, uu, vv, ww, uv, uw, vw
+         * \return    Time average
+        */
+        double GetMean(unsigned int const x, unsigned int const y, unsigned int const z, unsigned int const s) const
+        {
+            return (samples_ > 0) ? S_[((static_cast<size_t>(z)*NY + y)*NX + x)*NS_ + s]/static_cast<double>(samples_) : 0.0;
+        }
+
+        /**\fn        GetReynoldsStress
+         * \brief     Reynolds stress <u_a'u_b'> of a cell
+         *
+         * \param[in] x   x coordinate of cell
+         * \param[in] y   y coordinate of cell
+         * \param[in] z   z coordinate of cell
+         * \param[in] a   first velocity component (0: x, 1: y, 2: z)
+         * \param[in] b   second velocity component (0: x, 1: y, 2: z)
+         * \return    Reynolds stress
+        */
+        double GetReynoldsStress(unsigned int const x, unsigned int const y, unsigned int const z, unsigned int const a, unsigned int const b) const
+        {
+            constexpr unsigned int PRODUCT[3][3] = { {4, 7, 8}, {7, 5, 9}, {8, 9, 6} };
+            return GetMean(x, y, z, PRODUCT[a][b]) - GetMean(x, y, z, 1 + a)*GetMean(x, y, z, 1 + b);
+        }
+
+        /**\fn        ExportVtk
+         * \brief     Export mean pressure, mean velocity, RMS velocity and Reynolds stresses to a *.vtk-file
+         *
+         * \param[in] name   the export file name
+        */
+        void ExportVtk(std::string const& name) const
+        {
+            struct stat info;
+
+            if (stat(OUTPUT_VTK_PATH.c_str(), &info) != 0 || !S_ISDIR(info.st_mode))
+            {
+                std::cerr << "Fatal error: Directory '" << OUTPUT_VTK_PATH << "' not found." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+
+            std::string const fileName = OUTPUT_VTK_PATH + std::string("/") + name + std::string(".vtk");
+            FILE * const exportFile = fopen(fileName.c_str(), "w");
+            if (exportFile == nullptr)
+            {
+                std::cerr << "Fatal error: Could not create '" << fileName << "'." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+
+            fprintf(exportFile, "# vtk DataFile Version 3.0\n");
+            fprintf(exportFile, "LBM CFD simulation statistics of %zu samples\n", samples_);
+            fprintf(exportFile, "ASCII\n");
+            fprintf(exportFile, "DATASET STRUCTURED_POINTS\n");
+            fprintf(exportFile, "DIMENSIONS %u %u %u\n", NX, NY, NZ);
+            fprintf(exportFile, "ORIGIN 0 0 0\n");
+            fprintf(exportFile, "SPACING 1 1 1\n");
+            fprintf(exportFile, "POINT_DATA %zu\n", static_cast<size_t>(NX)*NY*NZ);
+
+            fprintf(exportFile, "SCALARS mean_pressure float 1\n");
+            fprintf(exportFile, "LOOKUP_TABLE default\n");
+            for(unsigned int z = 0; z < NZ; ++z)
+            {
+                for(unsigned int y = 0; y < NY; ++y)
+                {
+                    for(unsigned int x = 0; x < NX; ++x)
+                    {
+                        fprintf(exportFile, "%e\n", CS2_*GetMean(x, y, z, 0));
+                    }
+                }
+            }
+
+            fprintf(exportFile, "VECTORS mean_velocity float\n");
+            for(unsigned int z = 0; z < NZ; ++z)
+            {
+                for(unsigned int y = 0; y < NY; ++y)
+                {
+                    for(unsigned int x = 0; x < NX; ++x)
+                    {
+                        fprintf(exportFile, "%e %e %e\n", GetMean(x, y, z, 1), GetMean(x, y, z, 2), GetMean(x, y, z, 3));
+                    }
+                }
+            }
+
+            fprintf(exportFile, "VECTORS rms_velocity float\n");
+            for(unsigned int z = 0; z < NZ; ++z)
+            {
+                for(unsigned int y = 0; y < NY; ++y)
+                {
+                    for(unsigned int x = 0; x < NX; ++x)
+                    {
+                        fprintf(exportFile, "%e %e %e\n", std::sqrt(std::max(GetReynoldsStress(x, y, z, 0, 0), 0.0)),
+                                                          std::sqrt(std::max(GetReynoldsStress(x, y, z, 1, 1), 0.0)),
+                                                          std::sqrt(std::max(GetReynoldsStress(x, y, z, 2, 2), 0.0)));
+                    }
+                }
+            }
+
+            fprintf(exportFile, "TENSORS reynolds_stress float\n");
+            for(unsigned int z = 0; z < NZ; ++z)
+            {
+                for(unsigned int y = 0; y < NY; ++y)
+                {
+                    for(unsigned int x = 0; x < NX; ++x)
+                    {
+                        for(unsigned int a = 0; a < 3; ++a)
+                        {
+                            fprintf(exportFile, "%e %e %e\n", GetReynoldsStress(x, y, z, a, 0),
+                                                              GetReynoldsStress(x, y, z, a, 1),
+                                                              GetReynoldsStress(x, y, z, a, 2));
+                        }
+                    }
+                }
+            }
+
+            fclose(exportFile);
+        }
+};
+
+#endif // STATISTICS_HPP_INCLUDED
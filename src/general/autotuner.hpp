@@ -0,0 +1,272 @@
+#ifndef AUTOTUNER_HPP_INCLUDED
+#define AUTOTUNER_HPP_INCLUDED
+
+/**
+ * \file     autotuner.hpp
+ * \mainpage Selection of the fastest kernel variant and number of threads at start-up
+ *
+ * \note     The fastest setting depends on the machine (cores, hyper-threading, memory bandwidth,
+ *           instruction sets) and on the domain. The autotuner times a few time steps of every
+ *           registered variant (e.g. a kernel or a partition of the loop blocks) for several thread
+ *           counts, keeps the fastest combination and stores it in a cache file. Later runs on the
+ *           same machine with the same domain read the setting from the cache and skip the timing.
+ *           Output:  AUTOTUNE_PATH/autotune.txt   lines of [machine, domain, variant, threads, MLUPS]
+ * \warning  The timed steps modify the populations: the initial conditions have to be set again
+ *           after tuning. Settings that change the type of the population (loop block size,
+ *           propagation pattern) are fixed at compile time and can not be tuned. The variants have
+ *           to be interchangeable: kernels only qualify if they model the same physics (e.g. the
+ *           generic and the vectorised BGK kernel) and support the same boundaries and statistics.
+*/
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "parallelism.hpp"
+#include "paths.hpp"
+#include "timer.hpp"
+
+
+/**\class  Autotuner
+ * \brief  Times registered variants for several thread counts and caches the fastest setting
+*/
+class Autotuner
+{
+    public:
+        /**\brief     Class constructor
+         *
+         * \param[in] domain    description of the domain (resolution, lattice, precision) used as cache key
+         * \param[in] steps     number of timed calls of every variant
+         * \param[in] repeats   number of repetitions of the timing (the fastest one counts)
+        */
+        Autotuner(std::string const& domain, unsigned int const steps = 5, unsigned int const repeats = 3):
+            machine_(Machine()), domain_(domain), steps_(steps), repeats_(repeats)
+        {
+            for(int threads = parallel::ThreadsMax(); threads >= 1; threads /= 2)
+            {
+                threads_.push_back(threads);
+            }
+        }
+
+        /**\fn        AddVariant
+         * \brief     Register a variant
+         *
+         * \param[in] label   name of the variant (cache entry, no tabs)
+         * \param[in] step    function performing an even and an odd time step with the variant
+         * \param[in] setup   function called before timing and when the variant is selected
+        */
+        void AddVariant(std::string const& label, std::function<void()> const& step,
+                        std::function<void()> const& setup = [](){})
+        {
+            variants_.push_back({label, step, setup});
+        }
+
+        /**\fn        SetThreads
+         * \brief     Replace the thread counts tried (default: all threads and repeated halving)
+         *
+         * \param[in] threads   thread counts
+        */
+        void SetThreads(std::vector<int> const& threads)
+        {
+            threads_ = threads;
+        }
+
+        /**\fn        Tune
+         * \brief     Select the fastest variant and number of threads, either from the cache or by
+         *            timing all combinations. Sets the number of threads and calls the setup of the
+         *            selected variant.
+         *
+         * \param[in] cells   number of lattice cells updated per time step
+         * \return    Label of the selected variant
+        */
+        std::string Tune(double const cells)
+        {
+            if (variants_.empty() == true)
+            {
+                std::cerr << "Fatal error: No variants registered for autotuning." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+
+            unsigned int best = 0;
+            int   best_threads = parallel::ThreadsMax();
+
+            if (Load(best, best_threads) == true)
+            {
+                std::cout << "Autotuning: cached setting '" << variants_[best].label << "' with "
+                          << best_threads << " threads" << std::endl;
+            }
+            else
+            {
+                double best_mlups = 0.0;
+                for(int const threads: threads_)
+                {
+                    parallel::SetThreads(threads);
+
+                    for(unsigned int v = 0; v < variants_.size(); ++v)
+                    {
+                        double const mlups = Measure(variants_[v], cells);
+                        std::cout << "Autotuning: '" << variants_[v].label << "' with " << threads
+                                  << " threads: " << mlups << " MLUPS" << std::endl;
+
+                        if (mlups > best_mlups)
+                        {
+                            best_mlups   = mlups;
+                            best         = v;
+                            best_threads = threads;
+                        }
+                    }
+                }
+
+                std::cout << "Autotuning: selected '" << variants_[best].label << "' with "
+                          << best_threads << " threads" << std::endl;
+                Save(variants_[best].label, best_threads, best_mlups);
+            }
+
+            parallel::SetThreads(best_threads);
+            variants_[best].setup();
+
+            return variants_[best].label;
+        }
+
+    private:
+        /**\class  Variant
+         * \brief  Registered variant
+        */
+        class Variant
+        {
+            public:
+                std::string           label;
+                std::function<void()> step;
+                std::function<void()> setup;
+        };
+
+        std::string const  machine_;    ///< description of the machine: host, processor and number of cores
+        std::string const   domain_;    ///< description of the domain
+        unsigned int const   steps_;    ///< number of timed calls of every variant
+        unsigned int const repeats_;    ///< number of repetitions of the timing
+        std::vector<Variant> variants_; ///< registered variants
+        std::vector<int>      threads_; ///< thread counts tried
+
+        /**\fn        Measure
+         * \brief     Performance of a variant for the current number of threads
+         *
+         * \param[in] variant   variant to be timed
+         * \param[in] cells     number of lattice cells updated per time step
+         * \return    Fastest repetition in million lattice updates per second
+        */
+        double Measure(Variant const& variant, double const cells) const
+        {
+            variant.setup();
+            variant.step();
+
+            double runtime = 0.0;
+            for(unsigned int r = 0; r < repeats_; ++r)
+            {
+                Timer Stopwatch;
+                Stopwatch.Start();
+                for(unsigned int s = 0; s < steps_; ++s)
+                {
+                    variant.step();
+                }
+                double const current = Stopwatch.Stop();
+                runtime = (r == 0) ? current : std::min(runtime, current);
+            }
+
+            return 2.0*steps_*cells/(runtime*1e6);
+        }
+
+        /**\fn        Load
+         * \brief     Look up the setting of the machine and domain in the cache file (latest entry)
+         *
+         * \param[out] variant   index of the cached variant
+         * \param[out] threads   cached number of threads
+         * \return    Boolean parameter signaling a valid entry for a registered variant
+        */
+        bool Load(unsigned int& variant, int& threads) const
+        {
+            std::ifstream file(AUTOTUNE_PATH + "/autotune.txt");
+            bool found = false;
+
+            std::string line;
+            while (std::getline(file, line))
+            {
+                std::vector<std::string> fields;
+                size_t start = 0;
+                for(size_t tab = line.find('\t'); tab != std::string::npos; tab = line.find('\t', start))
+                {
+                    fields.push_back(line.substr(start, tab - start));
+                    start = tab + 1;
+                }
+                fields.push_back(line.substr(start));
+
+                if ((fields.size() < 4) || (fields[0] != machine_) || (fields[1] != domain_))
+                {
+                    continue;
+                }
+
+                for(unsigned int v = 0; v < variants_.size(); ++v)
+                {
+                    int const cached = atoi(fields[3].c_str());
+                    if ((variants_[v].label == fields[2]) && (cached >= 1) && (cached <= parallel::Processors()))
+                    {
+                        variant = v;
+                        threads = cached;
+                        found   = true;
+                    }
+                }
+            }
+
+            return found;
+        }
+
+        /**\fn        Save
+         * \brief     Append the selected setting to the cache file
+         *
+         * \param[in] label     label of the selected variant
+         * \param[in] threads   selected number of threads
+         * \param[in] mlups     measured performance
+        */
+        void Save(std::string const& label, int const threads, double const mlups) const
+        {
+            std::ofstream file(AUTOTUNE_PATH + "/autotune.txt", std::ios::app);
+            file << machine_ << '\t' << domain_ << '\t' << label << '\t' << threads << '\t' << mlups << std::endl;
+
+            if (file.good() == false)
+            {
+                std::cerr << "Error: Could not write autotuning cache to '" << AUTOTUNE_PATH << "'." << std::endl;
+            }
+        }
+
+        /**\fn        Machine
+         * \brief     Description of the machine: host name, processor model and number of cores
+         *
+         * \return    Description without tabs
+        */
+        static std::string Machine()
+        {
+            char host[256] = {};
+            gethostname(host, sizeof(host) - 1);
+
+            std::string model = "unknown";
+            std::ifstream cpuinfo("/proc/cpuinfo");
+            std::string line;
+            while (std::getline(cpuinfo, line))
+            {
+                if (line.compare(0, 10, "model name") == 0)
+                {
+                    model = line.substr(line.find(':') + 2);
+                    break;
+                }
+            }
+
+            std::string machine = std::string(host) + " " + model + " " + std::to_string(parallel::Processors()) + " cores";
+            std::replace(machine.begin(), machine.end(), '\t', ' ');
+            return machine;
+        }
+};
+
+#endif // AUTOTUNER_HPP_INCLUDED
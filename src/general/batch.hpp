@@ -0,0 +1,167 @@
+#ifndef BATCH_HPP_INCLUDED
+#define BATCH_HPP_INCLUDED
+
+/**
+ * \file     batch.hpp
+ * \mainpage Parameter studies: several simulations running concurrently in a single process
+ *
+ * \note     Small cases scale poorly on many cores and launching the solver once per case repeats
+ *           the start-up (geometry, boundary lists, thread pool) for every case. The batch driver
+ *           reads a list of cases and runs them concurrently on nested teams: the outer team holds
+ *           one thread per concurrent case, every case gets an equal share of the cores for the
+ *           parallel regions of its kernels. Cases are handed out dynamically, so a team that
+ *           finishes early (e.g. steady state reached) starts the next case of the list.
+ *           Input:   case list with lines of [name, Reynolds number, velocity, time steps], '#' comments
+ *           Output:  OUTPUT_BIN_PATH/<name>_report.txt   parameters and performance of every case
+ *           Without OpenMP the cases run one after another.
+ * \warning  Nested parallelism has to be enabled beforehand (Parallelism::SetNestedParallelism).
+ *           All cases share the compile-time domain, lattice and the read-only geometry.
+*/
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "parallelism.hpp"
+#include "paths.hpp"
+#include "timer.hpp"
+
+
+/**\class  Case
+ * \brief  Parameters of a single simulation of a parameter study
+*/
+class Case
+{
+    public:
+        std::string  name_;   ///< name of the case (prefix of all its output files)
+        double       Re_;     ///< simulation Reynolds number
+        double       U_;      ///< characteristic velocity in lattice units
+        unsigned int NT_;     ///< number of time steps
+};
+
+/**\fn        ReadCases
+ * \brief     Read the list of cases of a parameter study
+ *
+ * \param[in] fileName   case list with lines of [name, Reynolds number, velocity, time steps]
+ * \return    Cases in the order of the list
+*/
+std::vector<Case> ReadCases(std::string const& fileName)
+{
+    std::ifstream file(fileName);
+
+    if (file.is_open() == false)
+    {
+        std::cerr << "Fatal error: Case list '" << fileName << "' not found." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::vector<Case> cases;
+    std::string line;
+    for(unsigned int number = 1; std::getline(file, line); ++number)
+    {
+        line = line.substr(0, line.find('#'));
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+        {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        Case current;
+        if (!(fields >> current.name_ >> current.Re_ >> current.U_ >> current.NT_) || (current.Re_ <= 0.0) || (current.U_ <= 0.0))
+        {
+            std::cerr << "Fatal error: Invalid case in line " << number << " of '" << fileName << "'." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        cases.push_back(current);
+    }
+
+    if (cases.empty() == true)
+    {
+        std::cerr << "Fatal error: Case list '" << fileName << "' is empty." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    return cases;
+}
+
+/**\fn        ExportReport
+ * \brief     Write parameters and performance of a finished case to disk
+ *
+ * \param[in] current   parameters of the case
+ * \param[in] steps     number of time steps performed (less than NT at steady state)
+ * \param[in] threads   number of threads of the case
+ * \param[in] runtime   wall time of the time steps in seconds
+ * \param[in] total     wall time of the case including set-up and export in seconds
+ * \param[in] cells     number of lattice cells updated per time step
+*/
+void ExportReport(Case const& current, size_t const steps, int const threads, double const runtime, double const total,
+                  double const cells)
+{
+    double const mlups = static_cast<double>(steps)*cells/(runtime*1e6);
+
+    std::ofstream file(OUTPUT_BIN_PATH + "/" + current.name_ + "_report.txt");
+    file << "case:            " << current.name_ << std::endl;
+    file << "Reynolds number: " << current.Re_   << std::endl;
+    file << "char. velocity:  " << current.U_    << std::endl;
+    file << "time steps:      " << steps << " of " << current.NT_ << std::endl;
+    file << "threads:         " << threads << std::endl;
+    file << "runtime:         " << runtime << " s" << std::endl;
+    file << "total wall time: " << total << " s" << std::endl;
+    file << "performance:     " << mlups << " MLUPS" << std::endl;
+
+    if (file.good() == false)
+    {
+        std::cerr << "Error: Could not write report of case '" << current.name_ << "'." << std::endl;
+    }
+
+    #pragma omp critical (batch_console)
+    {
+        std::cout << "Case '" << current.name_ << "' finished after " << steps << " time steps on "
+                  << threads << " threads: " << runtime << " s, " << mlups << " MLUPS" << std::endl;
+    }
+}
+
+/**\fn        RunBatch
+ * \brief     Run the cases concurrently on nested teams that split the available threads evenly
+ *
+ * \tparam    Simulation   callable with the signature size_t(Case const&, double& runtime) returning
+ *                         the number of time steps performed and the wall time of the time steps
+ * \param[in] cases        cases of the parameter study
+ * \param[in] concurrent   maximum number of cases running at the same time (0 = one thread per case)
+ * \param[in] cells        number of lattice cells updated per time step
+ * \param[in] simulation   function running a single case with the current number of threads
+*/
+template <typename Simulation>
+void RunBatch(std::vector<Case> const& cases, unsigned int const concurrent, double const cells, Simulation const& simulation)
+{
+    int const threads = parallel::ThreadsMax();
+    int const   teams = std::max(1, std::min({threads, static_cast<int>(cases.size()),
+                                              (concurrent > 0) ? static_cast<int>(concurrent) : threads}));
+
+    std::cout << "Running " << cases.size() << " cases on " << teams << " teams of "
+              << threads/teams << " threads..." << std::endl;
+
+    #pragma omp parallel for default(none) shared(cases,simulation) firstprivate(threads,teams,cells) schedule(dynamic,1) num_threads(teams)
+    for(size_t c = 0; c < cases.size(); ++c)
+    {
+        // remaining threads are given to the first teams
+        int const team = threads/teams + ((parallel::ThreadNum() < threads % teams) ? 1 : 0);
+        parallel::SetThreads(team);
+
+        Timer Stopwatch;
+        Stopwatch.Start();
+        double runtime = 0.0;
+        size_t const steps = simulation(cases[c], runtime);
+        double const total = Stopwatch.Stop();
+
+        ExportReport(cases[c], steps, team, runtime, total, cells);
+    }
+
+    parallel::SetThreads(threads);
+}
+
+#endif // BATCH_HPP_INCLUDED
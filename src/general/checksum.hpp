@@ -0,0 +1,67 @@
+#ifndef CHECKSUM_HPP_INCLUDED
+#define CHECKSUM_HPP_INCLUDED
+
+/**
+ * \file     checksum.hpp
+ * \mainpage Fast non-cryptographic checksum for detecting corrupted files
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+
+/**\fn        Checksum64
+ * \brief     64-bit checksum of an arbitrary block of memory: four independent multiply-rotate
+ *            streams over 64-bit words that are merged at the end (similar to xxHash64) so that
+ *            it is limited by memory bandwidth rather than latency
+ *
+ * \param[in] data    pointer to the data
+ * \param[in] bytes   number of bytes
+ * \return    The checksum of the data
+*/
+inline uint64_t Checksum64(void const* const data, size_t const bytes)
+{
+    constexpr uint64_t PRIME_1 = 0x9E3779B185EBCA87ULL;
+    constexpr uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr uint64_t PRIME_3 = 0x165667B19E3779F9ULL;
+
+    auto const rotate = [](uint64_t const x, unsigned int const r) { return (x << r) | (x >> (64 - r)); };
+    auto const round  = [&](uint64_t const acc, uint64_t const word) { return rotate(acc + word*PRIME_2, 31)*PRIME_1; };
+
+    unsigned char const* const bytePtr = static_cast<unsigned char const*>(data);
+
+    uint64_t acc[4] = { PRIME_1 + PRIME_2, PRIME_2, 0, 0 - PRIME_1 };
+
+    size_t i = 0;
+    for(; i + 32 <= bytes; i += 32)
+    {
+        for(unsigned int l = 0; l < 4; ++l)
+        {
+            uint64_t word;
+            memcpy(&word, bytePtr + i + 8*l, sizeof(uint64_t));
+            acc[l] = round(acc[l], word);
+        }
+    }
+
+    uint64_t hash = rotate(acc[0], 1) + rotate(acc[1], 7) + rotate(acc[2], 12) + rotate(acc[3], 18);
+    for(unsigned int l = 0; l < 4; ++l)
+    {
+        hash = (hash ^ round(0, acc[l]))*PRIME_1 + PRIME_3;
+    }
+    hash += static_cast<uint64_t>(bytes);
+
+    for(; i < bytes; ++i)
+    {
+        hash = rotate(hash ^ (bytePtr[i]*PRIME_3), 11)*PRIME_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME_2;
+    hash ^= hash >> 29;
+    hash *= PRIME_3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+#endif // CHECKSUM_HPP_INCLUDED
@@ -0,0 +1,258 @@
+#include "converter.hpp"
+
+#include <algorithm>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "paths.hpp"
+
+
+/// number of macroscopic values per cell in the *.bin export: rho, ux, uy, uz
+#define CONVERTER_NM       4
+
+/// number of cells that are converted at once
+#define CONVERTER_CHUNK    65536
+
+
+/**\fn         ReadParameter
+ * \brief      Read an unsigned integer parameter from the exported parameters.txt
+ *
+ * \param[in]  fileName   path of the parameter file
+ * \param[in]  key        name of the parameter
+ * \param[out] value      value of the parameter
+ * \return     Return true if the parameter could be found
+*/
+static bool ReadParameter(std::string const& fileName, std::string const& key, unsigned int& value)
+{
+    std::ifstream parameterFile(fileName);
+    std::string   line;
+
+    while (std::getline(parameterFile, line))
+    {
+        char         name[64] = {0};
+        unsigned int number   = 0;
+
+        if ((sscanf(line.c_str(), "%63s %u", name, &number) == 2) && (key == name))
+        {
+            value = number;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**\fn        StreamArray
+ * \brief     Stream a single array of the appended data section of a *.vti file: the selected
+ *            components of all cells are gathered portion by portion from the mapped input
+ *
+ * \tparam    T            floating data type of the values
+ * \param[in] input        mapped *.bin input
+ * \param[in] cells        number of cells
+ * \param[in] m_start      first macroscopic value of the array
+ * \param[in] components   number of components of the array
+ * \param[in] exportFile   the output file
+ * \return    Return true if the array could be written
+*/
+template <typename T>
+static bool StreamArray(T const* const input, size_t const cells, unsigned int const m_start, unsigned int const components,
+                        FILE* const exportFile)
+{
+    std::vector<T> buffer(static_cast<size_t>(CONVERTER_CHUNK)*components);
+
+    uint64_t const bytes = static_cast<uint64_t>(cells)*components*sizeof(T);
+    if (fwrite(&bytes, sizeof(uint64_t), 1, exportFile) != 1)
+    {
+        return false;
+    }
+
+    for(size_t start = 0; start < cells; start += CONVERTER_CHUNK)
+    {
+        size_t const end = std::min(start + CONVERTER_CHUNK, cells);
+
+        for(size_t i = start; i < end; ++i)
+        {
+            for(unsigned int c = 0; c < components; ++c)
+            {
+                buffer[(i - start)*components + c] = input[i*CONVERTER_NM + m_start + c];
+            }
+        }
+
+        if (fwrite(buffer.data(), sizeof(T), (end - start)*components, exportFile) != (end - start)*components)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int ConvertFile(std::string const& input, std::string const& output,
+                unsigned int const NX, unsigned int const NY, unsigned int const NZ, unsigned int const valueSize)
+{
+    size_t const cells = static_cast<size_t>(NX)*NY*NZ;
+    size_t const size  = cells*CONVERTER_NM*valueSize;
+
+    int const fd = open(input.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::cerr << "Error: Could not open '" << input << "'." << std::endl;
+        return EXIT_FAILURE;
+    }
+    void* const file = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (file == MAP_FAILED)
+    {
+        std::cerr << "Error: Could not map '" << input << "'." << std::endl;
+        return EXIT_FAILURE;
+    }
+    madvise(file, size, MADV_SEQUENTIAL);
+
+    FILE* const exportFile = fopen(output.c_str(), "wb");
+    if (exportFile == nullptr)
+    {
+        std::cerr << "Error: Could not create '" << output << "'." << std::endl;
+        munmap(file, size);
+        return EXIT_FAILURE;
+    }
+
+    char const* const type = (valueSize == sizeof(float)) ? "Float32" : "Float64";
+    uint64_t const densityBytes = static_cast<uint64_t>(cells)*valueSize;
+
+    fprintf(exportFile, "<?xml version=\"1.0\"?>\n");
+    fprintf(exportFile, "<VTKFile type=\"ImageData\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n");
+    fprintf(exportFile, "  <ImageData WholeExtent=\"0 %u 0 %u 0 %u\" Origin=\"0 0 0\" Spacing=\"1 1 1\">\n", NX - 1, NY - 1, NZ - 1);
+    fprintf(exportFile, "    <Piece Extent=\"0 %u 0 %u 0 %u\">\n", NX - 1, NY - 1, NZ - 1);
+    fprintf(exportFile, "      <PointData Scalars=\"density\" Vectors=\"velocity\">\n");
+    fprintf(exportFile, "        <DataArray type=\"%s\" Name=\"density\" NumberOfComponents=\"1\" format=\"appended\" offset=\"0\"/>\n", type);
+    fprintf(exportFile, "        <DataArray type=\"%s\" Name=\"velocity\" NumberOfComponents=\"3\" format=\"appended\" offset=\"%llu\"/>\n",
+            type, static_cast<unsigned long long>(sizeof(uint64_t) + densityBytes));
+    fprintf(exportFile, "      </PointData>\n");
+    fprintf(exportFile, "    </Piece>\n");
+    fprintf(exportFile, "  </ImageData>\n");
+    fprintf(exportFile, "  <AppendedData encoding=\"raw\">\n");
+    fprintf(exportFile, "_");
+
+    bool success = false;
+    if (valueSize == sizeof(float))
+    {
+        float const* const values = static_cast<float const*>(file);
+        success = StreamArray(values, cells, 0, 1, exportFile) && StreamArray(values, cells, 1, 3, exportFile);
+    }
+    else
+    {
+        double const* const values = static_cast<double const*>(file);
+        success = StreamArray(values, cells, 0, 1, exportFile) && StreamArray(values, cells, 1, 3, exportFile);
+    }
+
+    fprintf(exportFile, "\n  </AppendedData>\n");
+    fprintf(exportFile, "</VTKFile>\n");
+
+    success = (fclose(exportFile) == 0) && success;
+    munmap(file, size);
+
+    if (success == false)
+    {
+        std::cerr << "Error: Could not write '" << output << "'." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+int ConvertBinToVtk(std::string const& directory)
+{
+    struct stat info;
+
+    if (stat(OUTPUT_VTK_PATH.c_str(), &info) != 0 || !S_ISDIR(info.st_mode))
+    {
+        std::cerr << "Fatal error: Directory '" << OUTPUT_VTK_PATH << "' not found." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    /// domain resolution from parameter file
+    std::string const parameterFile = directory + std::string("/parameters.txt");
+    unsigned int NX = 0;
+    unsigned int NY = 0;
+    unsigned int NZ = 0;
+    if (!ReadParameter(parameterFile, "NX", NX) || !ReadParameter(parameterFile, "NY", NY) || !ReadParameter(parameterFile, "NZ", NZ))
+    {
+        std::cerr << "Fatal error: Could not read resolution from '" << parameterFile << "'." << std::endl;
+        return EXIT_FAILURE;
+    }
+    size_t const cells = static_cast<size_t>(NX)*NY*NZ;
+
+    /// all *.bin files of the directory: precision is deduced from file size
+    DIR* const dir = opendir(directory.c_str());
+    if (dir == nullptr)
+    {
+        std::cerr << "Fatal error: Directory '" << directory << "' not found." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::string>  names;
+    std::vector<unsigned int> valueSizes;
+    for(struct dirent* entry = readdir(dir); entry != nullptr; entry = readdir(dir))
+    {
+        std::string const name = entry->d_name;
+        if ((name.size() <= 4) || (name.compare(name.size() - 4, 4, ".bin") != 0))
+        {
+            continue;
+        }
+
+        std::string const path = directory + std::string("/") + name;
+        if ((stat(path.c_str(), &info) != 0) || !S_ISREG(info.st_mode))
+        {
+            continue;
+        }
+
+        size_t const size = info.st_size;
+        if (size == cells*CONVERTER_NM*sizeof(double))
+        {
+            names.push_back(name);
+            valueSizes.push_back(sizeof(double));
+        }
+        else if (size == cells*CONVERTER_NM*sizeof(float))
+        {
+            names.push_back(name);
+            valueSizes.push_back(sizeof(float));
+        }
+        else
+        {
+            std::cerr << "Warning: Skipping '" << name << "' as its size does not match the resolution." << std::endl;
+        }
+    }
+    closedir(dir);
+
+    std::cout << "Converting " << names.size() << " files (" << NX << "x" << NY << "x" << NZ << ")..." << std::endl;
+
+    int failures = 0;
+    #pragma omp parallel for default(none) shared(directory,names,valueSizes,NX,NY,NZ,OUTPUT_VTK_PATH) reduction(+:failures) schedule(dynamic,1)
+    for(size_t i = 0; i < names.size(); ++i)
+    {
+        std::string const input  = directory + std::string("/") + names[i];
+        std::string const output = OUTPUT_VTK_PATH + std::string("/") + names[i].substr(0, names[i].size() - 4) + std::string(".vti");
+
+        if (ConvertFile(input, output, NX, NY, NZ, valueSizes[i]) != EXIT_SUCCESS)
+        {
+            ++failures;
+        }
+    }
+
+    std::cout << "Converted " << names.size() - failures << "/" << names.size() << " files." << std::endl;
+
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,41 @@
+#ifndef CONVERTER_HPP_INCLUDED
+#define CONVERTER_HPP_INCLUDED
+
+/**
+ * \file     converter.hpp
+ * \brief    Off-line conversion of exported *.bin files to *.vti files
+ *
+ * \mainpage The *.bin export written during the simulation is fast but can't be displayed by
+ *           visualisation applications directly. The converter takes a directory holding the
+ *           exported *.bin files together with the corresponding parameters.txt and converts all
+ *           of them in parallel to VTK image data files (*.vti) with appended binary data that can
+ *           be read by ParaView. Every input file is mapped to memory and streamed to the output
+ *           in small portions so that no full field has to be held in memory.
+*/
+
+#include <string>
+
+
+/**\fn        ConvertBinToVtk
+ * \brief     Convert all *.bin files of the given directory to *.vti files in OUTPUT_VTK_PATH
+ *
+ * \param[in] directory   directory holding the *.bin files and the parameters.txt
+ * \return    Return exit success or failure
+*/
+int ConvertBinToVtk(std::string const& directory);
+
+/**\fn        ConvertFile
+ * \brief     Convert a single *.bin file of the given resolution to a *.vti file
+ *
+ * \param[in] input       path of the *.bin input file
+ * \param[in] output      path of the *.vti output file
+ * \param[in] NX          simulation domain resolution in x-direction
+ * \param[in] NY          simulation domain resolution in y-direction
+ * \param[in] NZ          simulation domain resolution in z-direction
+ * \param[in] valueSize   size of a single value in bytes (4: float, 8: double)
+ * \return    Return exit success or failure
+*/
+int ConvertFile(std::string const& input, std::string const& output,
+                unsigned int const NX, unsigned int const NY, unsigned int const NZ, unsigned int const valueSize);
+
+#endif // CONVERTER_HPP_INCLUDED
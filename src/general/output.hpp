@@ -24,6 +24,7 @@
  * \tparam    NY    spatial resolution of the simulation domain in y-direction
  * \tparam    NZ    spatial resolution of the simulation domain in z-direction
  * \tparam    LT    static lattice::DdQq class containing discretisation parameters
+ * \tparam    PROP  propagation pattern
  * \tparam    T     floating data type used for simulation
  * \param[in] pop   population object holding microscopic variables
  * \param[in] NT    number of simulation time steps
@@ -32,8 +33,8 @@
  * \param[in] U     characteristic velocity (measurement for temporal resolution)
  * \param[in] L     characteristic length scale of the problem
 */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, typename T>
-void InitialOutput(Population<NX,NY,NZ,LT> const& pop, unsigned int const NT,
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class PROP, typename T>
+void InitialOutput(Population<NX,NY,NZ,LT,1,PROP> const& pop, unsigned int const NT,
                    T const Re, T const RHO, T const U, unsigned int const L)
 {
     printf("LBM simulation\n\n");
@@ -76,6 +77,7 @@ void StatusOutput(unsigned int const step, unsigned int NT)
  * \tparam    NY        spatial resolution of the simulation domain in y-direction
  * \tparam    NZ        spatial resolution of the simulation domain in z-direction
  * \tparam    LT        static lattice::DdQq class containing discretisation parameters
+ * \tparam    PROP      propagation pattern
  * \tparam    T         floating data type used for simulation
  * \param[in] con       continuum object holding macroscopic variables
  * \param[in] pop       population object holding microscopic variables
@@ -83,8 +85,8 @@ void StatusOutput(unsigned int const step, unsigned int NT)
  * \param[in] NT_PLOT   time between two plot time steps
  * \param[in] runtime   simulation runtime in seconds
 */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, typename T>
-void PerformanceOutput(Continuum<NX,NY,NZ,T> const& con, Population<NX,NY,NZ,LT>& pop, unsigned int const NT, double NT_PLOT, double const runtime)
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class PROP, typename T>
+void PerformanceOutput(Continuum<NX,NY,NZ,T> const& con, Population<NX,NY,NZ,LT,1,PROP>& pop, unsigned int const NT, double NT_PLOT, double const runtime)
 {
     constexpr double bytesPerMiB = 1024.0 * 1024.0;
     constexpr double bytesPerGiB = bytesPerMiB * 1024.0;
@@ -9,10 +9,87 @@
  *           the parallel environment OpenMP
 */
 
+#include <chrono>
 #if __has_include (<omp.h>)
     #include <omp.h>
 #endif
 
+
+/**\namespace parallel
+ * \brief     Thin wrappers of the OpenMP runtime functions used by the kernels that fall back to a
+ *            single thread and std::chrono timing if the code is compiled without OpenMP
+*/
+namespace parallel
+{
+    /**\fn        ThreadsMax
+     * \brief     Number of threads of the next parallel region
+     *
+     * \return    Number of threads (1 without OpenMP)
+    */
+    inline int ThreadsMax()
+    {
+        #ifdef _OPENMP
+            return omp_get_max_threads();
+        #else
+            return 1;
+        #endif
+    }
+
+    /**\fn        ThreadNum
+     * \brief     Number of the calling thread within the current team
+     *
+     * \return    Thread number (0 without OpenMP)
+    */
+    inline int ThreadNum()
+    {
+        #ifdef _OPENMP
+            return omp_get_thread_num();
+        #else
+            return 0;
+        #endif
+    }
+
+    /**\fn        SetThreads
+     * \brief     Set the number of threads of the following parallel regions (no effect without OpenMP)
+     *
+     * \param[in] threads   number of threads
+    */
+    inline void SetThreads([[maybe_unused]] int const threads)
+    {
+        #ifdef _OPENMP
+            omp_set_num_threads(threads);
+        #endif
+    }
+
+    /**\fn        Processors
+     * \brief     Number of available processors
+     *
+     * \return    Number of processors (1 without OpenMP)
+    */
+    inline int Processors()
+    {
+        #ifdef _OPENMP
+            return omp_get_num_procs();
+        #else
+            return 1;
+        #endif
+    }
+
+    /**\fn        WallTime
+     * \brief     Elapsed wall clock time in seconds with respect to an arbitrary fixed point in the past
+     *
+     * \return    Wall clock time in seconds
+    */
+    inline double WallTime()
+    {
+        #ifdef _OPENMP
+            return omp_get_wtime();
+        #else
+            return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        #endif
+    }
+}
+
 #ifdef _OPENMP
     /**\class    Parallelism
      * \brief    Class for all variables regarding parallelism
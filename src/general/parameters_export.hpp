@@ -23,6 +23,7 @@
  * \tparam    NY      spatial resolution of the simulation domain in y-direction
  * \tparam    NZ      spatial resolution of the simulation domain in z-direction
  * \tparam    LT      static lattice::DdQq class containing discretisation parameters
+ * \tparam    PROP    propagation pattern
  * \tparam    T       floating data type used for simulation
  * \param[in] pop     population object holding microscopic variables
  * \param[in] NT      number of simulation time steps
@@ -31,8 +32,8 @@
  * \param[in] L       characteristic length scale of the problem
  * \param[in] U       characteristic velocity (measurement for temporal resolution)
 */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, typename T>
-void ExportParameters(Population<NX,NY,NZ,LT> const& pop, unsigned int const NT, T const Re, T const RHO_0, T const U, unsigned int const L)
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class PROP, typename T>
+void ExportParameters(Population<NX,NY,NZ,LT,1,PROP> const& pop, unsigned int const NT, T const Re, T const RHO_0, T const U, unsigned int const L)
 {
     struct stat info;
 
@@ -17,4 +17,7 @@ std::string const BACKUP_EXPORT_PATH = "backup";
 std::string const OUTPUT_BIN_PATH = "output/bin";
 std::string const OUTPUT_VTK_PATH = "output/vtk";
 
+/// Autotuning results cached per machine and domain
+std::string const AUTOTUNE_PATH = "output";
+
 #endif // PATHS_HPP_INCLUDED
@@ -6,6 +6,8 @@
  * \mainpage 3D cylinder sample geometry import
 */
 
+#include <array>
+#include <cmath>
 #include <string.h>
 #include <vector>
 
@@ -52,16 +54,16 @@ void Cylinder3D(unsigned int const radius, std::array<unsigned int,3> const& pos
                     /// create element
                     boundaryElement<T> const element = {x, y, z, RHO, U, V, W};
 
-                    /// add to corresponding boundary
+                    /// add to corresponding boundary: cylinder is body 0, side walls are body 1
                     if ((x-position[0])*(x-position[0]) + (y-position[1])*(y-position[1]) <= radius*radius)
                     {
-                        wall.push_back(element);
+                        wall.push_back({x, y, z, RHO, U, V, W, 0});
                     }
                     else if ((y == 0) || (y == NY-1) || (z == 0) || (z == NZ-1))
                     {
                         if (walls == true)
                         {
-                            wall.push_back(element);
+                            wall.push_back({x, y, z, RHO, U, V, W, 1});
                         }
                     }
                     else if (x == 0)
@@ -83,4 +85,39 @@ void Cylinder3D(unsigned int const radius, std::array<unsigned int,3> const& pos
     }
 }
 
+/**\fn         CylinderDistance
+ * \brief      Relative distance of the surface of the cylinder of Cylinder3D along a link from a
+ *             fluid cell for interpolated bounce-back
+ *
+ * \tparam     T          floating data type used for simulation
+ * \param[in]  radius     unsigned integer that holds the radius of the cylinder
+ * \param[in]  position   array of unsigned integers that holds the position of the center of the
+ *                        cylinder
+ * \param[in]  x          x coordinate of the fluid cell
+ * \param[in]  y          y coordinate of the fluid cell
+ * \param[in]  cx         lattice velocity of the link in x-direction
+ * \param[in]  cy         lattice velocity of the link in y-direction
+ * \return     Relative distance q in (0,1] or 1/2 if the link does not cut the cylinder (e.g. side walls)
+*/
+template <typename T = double>
+T CylinderDistance(unsigned int const radius, std::array<unsigned int,3> const& position,
+                   unsigned int const x, unsigned int const y, int const cx, int const cy)
+{
+    /// intersection of the link x + q c with the circle |x - position| = radius
+    double const dx = static_cast<double>(x) - static_cast<double>(position[0]);
+    double const dy = static_cast<double>(y) - static_cast<double>(position[1]);
+    int    const a  = cx*cx + cy*cy;
+    double const b  = 2.0*(dx*cx + dy*cy);
+    double const c  = dx*dx + dy*dy - static_cast<double>(radius)*radius;
+    double const discriminant = b*b - 4.0*a*c;
+
+    if ((a == 0) || (discriminant < 0.0))
+    {
+        return static_cast<T>(0.5);
+    }
+
+    double const q = (-b - std::sqrt(discriminant))/(2.0*a);
+    return ((q > 0.0) && (q <= 1.0)) ? static_cast<T>(q) : static_cast<T>(0.5);
+}
+
 #endif // CYLINDER_HPP_INCLUDED
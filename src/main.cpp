@@ -2,30 +2,47 @@
 #include <iostream>
 #include <memory>
 #include <stdlib.h>
+#include <string>
 #include <string.h>
 #include <vector>
 
 #include "continuum/continuum.hpp"
 #include "continuum/initialisation.hpp"
+#include "continuum/monitor.hpp"
+#include "continuum/statistics.hpp"
+#include "general/autotuner.hpp"
+#include "general/batch.hpp"
+#include "general/converter.hpp"
 #include "general/disclaimer.hpp"
 #include "general/memory_alignment.hpp"
 #include "general/output.hpp"
 #include "general/parallelism.hpp"
 #include "general/parameters_export.hpp"
+#include "general/paths.hpp"
 #include "general/timer.hpp"
 #include "geometry/cylinder.hpp"
 #include "lattice/D3Q27.hpp"
 #include "population/boundary/boundary.hpp"
 #include "population/boundary/boundary_bounceback.hpp"
+#include "population/boundary/boundary_bouzidi.hpp"
+#include "population/boundary/boundary_convective.hpp"
 #include "population/boundary/boundary_guo.hpp"
+#include "population/boundary/boundary_links.hpp"
+#include "population/boundary/boundary_list.hpp"
+#include "population/boundary/boundary_momentum.hpp"
 #include "population/boundary/boundary_orientation.hpp"
+#include "population/boundary/boundary_sponge.hpp"
 #include "population/boundary/boundary_type.hpp"
+#include "population/boundary/boundary_wall_function.hpp"
 #include "population/collision/collision_bgk.hpp"
 #include "population/collision/collision_bgk-s.hpp"
 #include "population/collision/collision_bgk_avx2.hpp"
 #include "population/collision/collision_trt.hpp"
 #include "population/initialisation.hpp"
+#include "population/macroscopic.hpp"
 #include "population/population.hpp"
+#include "population/population_checkpoint.hpp"
+#include "population/population_observer.hpp"
 
 int main(int argc, char** argv)
 {
@@ -36,6 +53,9 @@ int main(int argc, char** argv)
     #endif
 
     /// print disclaimer ---------------------------------------------------------------------------
+    std::string batchList = "";
+    unsigned int batchConcurrent = 0;
+
     if (argc > 1)
     {
         if ((strcmp(argv[1], "--version") == 0) || (strcmp(argv[1], "--v") == 0))
@@ -45,12 +65,23 @@ int main(int argc, char** argv)
         }
         else if (strcmp(argv[1], "--convert") == 0)
         {
-            std::cerr << "Error: Feature not implemented yet." << std::endl;
-            exit(EXIT_FAILURE);
+            std::string const directory = (argc > 2) ? argv[2] : OUTPUT_BIN_PATH;
+            exit(ConvertBinToVtk(directory));
+        }
+        else if (strcmp(argv[1], "--batch") == 0)
+        {
+            if (argc < 3)
+            {
+                std::cerr << "Fatal error: No case list given." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            batchList       = argv[2];
+            batchConcurrent = (argc > 3) ? static_cast<unsigned int>(atoi(argv[3])) : 0;
         }
         else if ((strcmp(argv[1], "--info") == 0) || (strcmp(argv[1], "--help") == 0))
         {
-            std::cerr << "Usage: '--convert'             Convert *.bin files to *.vtk" << std::endl;
+            std::cerr << "Usage: '--convert' [directory] Convert *.bin files to *.vti" << std::endl;
+            std::cerr << "       '--batch'   file [cases] Run the cases of a list concurrently" << std::endl;
             std::cerr << "       '--help'    or '--info' Show help"                    << std::endl;
             std::cerr << "       '--version' or '--v'    Show build version"           << std::endl;
             exit(EXIT_SUCCESS);
@@ -81,16 +112,40 @@ int main(int argc, char** argv)
     constexpr F_TYPE   V_0 = 0.0;
     constexpr F_TYPE   W_0 = 0.0;
 
+    // non-reflecting outlet: width of the absorbing layer in cells, maximum relaxation rate towards the
+    // far field per time step and maximum additional viscosity in lattice units
+    constexpr unsigned int   SPONGE_WIDTH = NX/8;
+    constexpr F_TYPE      SPONGE_STRENGTH = 0.05;
+    constexpr F_TYPE     SPONGE_VISCOSITY = 0.1;
+
+    // wall function on the side walls for under-resolved boundary layers (equilibrium log law instead of no-slip)
+    constexpr bool WALL_FUNCTION = false;
+
+    // warm start from exported macroscopic values (name of *.bin-file, empty for initial conditions above)
+    std::string const  RESTART_NAME = "";
+    constexpr unsigned int RESTART_STEP = 0;
+
     // save values to disk after each time step (disable for benchmark)
     constexpr bool save = true;
 
-    /// set up microscopic and macroscopic arrays --------------------------------------------------
-    Continuum<NX,NY,NZ,F_TYPE> Macro;
-    Population<NX,NY,NZ,DdQq>  Micro(Re,U,L);
-    InitialOutput(Micro, NT, Re, RHO_0, U, L);
-    ExportParameters(Micro, NT, Re, RHO_0, U, L);
+    // global diagnostics: number of time steps between two checks and relative change of velocity for steady state
+    constexpr unsigned int MONITOR_INTERVAL = 100;
+    constexpr double      MONITOR_TOLERANCE = 1e-6;
+
+    // turbulence statistics: number of time steps between two samples (during the second half of the time steps)
+    constexpr unsigned int STATISTICS_INTERVAL = 10;
+
+    // back-up: wall time between two checkpoints in seconds and number of checkpoints kept
+    constexpr double   CHECKPOINT_INTERVAL = 3600.0;
+    constexpr unsigned int CHECKPOINT_KEEP = 2;
+
+    // autotuning at start-up: number of timed pairs of time steps per setting (0 to disable)
+    constexpr unsigned int AUTOTUNE_STEPS = 5;
 
-    /// define boundary conditions -----------------------------------------------------------------
+    // out-of-core: file holding the populations for lattices larger than main memory (empty for main memory)
+    std::string const STORAGE = "";
+
+    /// geometry shared by all simulations --------------------------------------------------------
     alignas(CACHE_LINE) std::vector<boundaryElement<F_TYPE>> wall;
     alignas(CACHE_LINE) std::vector<boundaryElement<F_TYPE>> inlet;
     alignas(CACHE_LINE) std::vector<boundaryElement<F_TYPE>> outlet;
@@ -99,48 +154,285 @@ int main(int argc, char** argv)
     constexpr std::array<unsigned int,3> position = {NX/4, NY/2, NZ/2};
     Cylinder3D<NX,NY,NZ>(radius, position, "x", true, wall, inlet, outlet, RHO_0, U_0, V_0, W_0);
 
-    /// define initial conditions ------------------------------------------------------------------
-    InitContinuum(Macro, RHO_0, U_0, V_0, W_0);
-    InitLattice<false>(Macro, Micro);
+    // cell types: only solid cells on the surface are treated by bounce-back
+    CellFlags<NX,NY,NZ,Population<NX,NY,NZ,DdQq>::BLOCK_SIZE_> Flags;
+    Flags.Set(wall, SOLID);
+    Flags.Update();
 
-    /// main loop ----------------------------------------------------------------------------------
-    std::cout << "Simulation started..." << std::endl;
+    // compact list of the solid surface with precomputed population indices
+    BoundaryList<NX,NY,NZ,DdQq> const Wall(Flags.Surface(wall));
 
-    Timer Stopwatch;
-    Stopwatch.Start();
+    // bounce-back only along the links between fluid and solid cells, interpolated with the exact
+    // distance of the cylinder surface (body 0), halfway at the side walls (body 1)
+    LinkList<NX,NY,NZ,DdQq> const Links(Wall, Flags);
+    BouzidiLinks<NX,NY,NZ,DdQq> const Curved(Links, Flags, [&](unsigned int const x, unsigned int const y, unsigned int const,
+                                                               int const cx, int const cy, int const, unsigned int const body)
+                                             { return (body == 0) ? CylinderDistance<F_TYPE>(radius, position, x, y, cx, cy)
+                                                                  : static_cast<F_TYPE>(0.5); });
 
-    for (size_t i = 0; i < NT; i+=2)
+    // wall function on the first fluid cells next to the side walls: not at the edges, the inlet and the
+    // outlet and not next to the cylinder (the side walls are bounced back halfway by the links above)
+    alignas(CACHE_LINE) std::vector<boundaryElement<F_TYPE>> front;
+    alignas(CACHE_LINE) std::vector<boundaryElement<F_TYPE>> back;
+    alignas(CACHE_LINE) std::vector<boundaryElement<F_TYPE>> bottom;
+    alignas(CACHE_LINE) std::vector<boundaryElement<F_TYPE>> top;
+    for(unsigned int x = 1; x < NX-1; ++x)
     {
-        // even time step
-        Guo<false,type::Velocity,orientation::Left>(inlet,  Micro, 0);
-        Guo<false,type::Pressure,orientation::Right>(outlet, Micro, 0);
-        CollideStreamBGK_Smagorinsky<false>(Macro, Micro, save, 0);
-        BounceBackHalfway<false>(wall, Micro, 0);
+        for(unsigned int z = 2; z < NZ-2; ++z)
+        {
+            front.push_back({x, 1,    z, RHO_0, 0.0, 0.0, 0.0, 1});
+            back.push_back( {x, NY-2, z, RHO_0, 0.0, 0.0, 0.0, 1});
+        }
+        for(unsigned int y = 2; y < NY-2; ++y)
+        {
+            if ((x-position[0])*(x-position[0]) + (y-position[1])*(y-position[1]) > (radius+2)*(radius+2))
+            {
+                bottom.push_back({x, y, 1,    RHO_0, 0.0, 0.0, 0.0, 1});
+                top.push_back(   {x, y, NZ-2, RHO_0, 0.0, 0.0, 0.0, 1});
+            }
+        }
+    }
+    BoundaryList<NX,NY,NZ,DdQq,orientation::Front>  const FrontWall(front);
+    BoundaryList<NX,NY,NZ,DdQq,orientation::Back>   const BackWall(back);
+    BoundaryList<NX,NY,NZ,DdQq,orientation::Bottom> const BottomWall(bottom);
+    BoundaryList<NX,NY,NZ,DdQq,orientation::Top>    const TopWall(top);
 
-        // odd time step
-        Guo<true,type::Velocity,orientation::Left>(inlet, Micro, 0);
-        Guo<true,type::Pressure,orientation::Right>(outlet, Micro, 0);
-        CollideStreamBGK_Smagorinsky<true>(Macro, Micro, save, 0);
-        BounceBackHalfway<true>(wall, Micro, 0);
+    /// single simulation: output files are prefixed with the name of the case in batch mode --------
+    bool const batch = (batchList.empty() == false);
+
+    auto const Simulation = [&](Case const& current, double& runtime) -> size_t
+    {
+        F_TYPE const caseRe = static_cast<F_TYPE>(current.Re_);
+        F_TYPE const  caseU = static_cast<F_TYPE>(current.U_);
+        std::string const prefix = (batch == true) ? current.name_ + "_" : "";
+        bool const output = (save == true) && (batch == false);
 
-        if ((save == true) && (i % (NT/10) == 0))
+        /// set up microscopic and macroscopic arrays ----------------------------------------------
+        Continuum<NX,NY,NZ,F_TYPE> Macro;
+        Population<NX,NY,NZ,DdQq>  Micro(caseRe, caseU, L, 0.25, ((batch == true) && (STORAGE.empty() == false)) ? prefix + STORAGE : STORAGE);
+        if (batch == false)
         {
-            StatusOutput(i, NT);
-            Macro.SetZero(wall);
-            //Macro.Export("step",i);
-            Macro.ExportVtk(i);
+            InitialOutput(Micro, current.NT_, caseRe, RHO_0, caseU, L);
+            ExportParameters(Micro, current.NT_, caseRe, RHO_0, caseU, L);
+        }
+
+        // cell types of the shared geometry, partition of the loop blocks weighted by the fluid cells (before first touch)
+        Micro.flags_ = Flags;
+        Micro.schedule_.Estimate(Micro.order_, Micro.flags_);
+
+        /// define boundary conditions -------------------------------------------------------------
+        // inlet and outlet with the velocity of the case
+        alignas(CACHE_LINE) std::vector<boundaryElement<F_TYPE>> inletCase;
+        alignas(CACHE_LINE) std::vector<boundaryElement<F_TYPE>> outletCase;
+        for(auto const& e: inlet)
+        {
+            inletCase.push_back({e.x, e.y, e.z, e.rho, caseU, e.v, e.w, e.body});
+        }
+        for(auto const& e: outlet)
+        {
+            outletCase.push_back({e.x, e.y, e.z, e.rho, caseU, e.v, e.w, e.body});
+        }
+        BoundaryList<NX,NY,NZ,DdQq,orientation::Left>  const Inlet(inletCase);
+        BoundaryList<NX,NY,NZ,DdQq,orientation::Right> const Outlet(outletCase);
+
+        // convective outflow behind an absorbing layer: vortices leave the domain without being reflected
+        ConvectiveOutflow<NX,NY,NZ,DdQq,orientation::Right> Outflow(Outlet, caseU);
+        Sponge<NX,NY,NZ,DdQq> Layer(SPONGE_STRENGTH, SPONGE_VISCOSITY, RHO_0, caseU, V_0, W_0);
+        Layer.AddLayer<orientation::Right>(SPONGE_WIDTH);
+
+        // drag and lift on the cylinder (body 0) and the side walls (body 1) by momentum exchange
+        MomentumExchange<NX,NY,NZ,DdQq> Forces(Curved, prefix + "forces");
+
+        /// define initial conditions --------------------------------------------------------------
+        auto const InitialConditions = [&]()
+        {
+            if (RESTART_NAME.empty() == true)
+            {
+                InitContinuum(Macro, RHO_0, caseU, V_0, W_0);
+                InitLattice<false>(Macro, Micro);
+            }
+            else
+            {
+                Macro.Import(RESTART_NAME, RESTART_STEP);
+                InitLatticeNonEquilibrium<false>(Macro, Micro);
+            }
+        };
+        InitialConditions();
+
+        /// autotuning: number of threads and partition of the loop blocks (the threads of a case are set by the batch)
+        if ((AUTOTUNE_STEPS > 0) && (batch == false))
+        {
+            auto const Sweeps = [&]()
+            {
+                Micro.SweepSlabs([&](unsigned int const block_begin, unsigned int const block_end)
+                {
+                    CollideStreamBGK_Smagorinsky<false>(Macro, Micro, 0, block_begin, block_end, nullptr, nullptr, &Layer);
+                });
+                Micro.SweepSlabs([&](unsigned int const block_begin, unsigned int const block_end)
+                {
+                    CollideStreamBGK_Smagorinsky<true>(Macro, Micro, 0, block_begin, block_end, nullptr, nullptr, &Layer);
+                });
+            };
+
+            std::string const domain = std::to_string(NX) + "x" + std::to_string(NY) + "x" + std::to_string(NZ) + " D3Q" +
+                                       std::to_string(DdQq::SPEEDS) + " " + std::to_string(sizeof(F_TYPE)) + " byte";
+            Autotuner Tuner(domain, AUTOTUNE_STEPS);
+            Tuner.AddVariant("geometry", Sweeps, [&](){ Micro.schedule_.Estimate(Micro.order_, Micro.flags_); });
+            Tuner.AddVariant("uniform",  Sweeps, [&](){ Micro.schedule_.Reset(Micro.order_); });
+            Tuner.AddVariant("measured", Sweeps, [&]()
+            {
+                Micro.schedule_.Estimate(Micro.order_, Micro.flags_);
+                Micro.schedule_.measure_ = true;
+                Sweeps();
+                Sweeps();
+                Micro.schedule_.measure_ = false;
+                Micro.schedule_.Adapt(Micro.order_);
+            });
+            Tuner.Tune(static_cast<double>(NX)*NY*NZ);
+
+            // the timed steps advanced the flow field
+            InitialConditions();
         }
-    }
 
-    Stopwatch.Stop();
+        /// global diagnostics and early termination at steady state ------------------------------
+        Monitor<NX,NY,NZ,F_TYPE> Diagnostics(MONITOR_INTERVAL, MONITOR_TOLERANCE, prefix + "monitor");
 
-    PerformanceOutput(Macro, Micro, NT, NT, Stopwatch.GetRuntime());
+        /// time averages and Reynolds stresses accumulated by the kernels -------------------------
+        Statistics<NX,NY,NZ,F_TYPE> Stats(current.NT_/2, STATISTICS_INTERVAL);
 
-    /// final export -------------------------------------------------------------------------------
-    /*Macro.SetZero(wall);
-    Macro.Export("step",NT);
-    Macro.ExportVtk(NT);
-    Macro.ExportScalarVtk(0,"rho",NT);*/
+        /// probes in the wake of the cylinder sampled every other time step -----------------------
+        Observer<NX,NY,NZ,DdQq> Probes(Micro, prefix + "probes", 2);
+        for(unsigned int d = 1; d <= 4; ++d)
+        {
+            Probes.AddPoint(position[0] + d*L, position[1], position[2]);
+        }
+
+        /// periodic non-blocking back-up (forks the process and installs a signal handler: not in batch mode)
+        std::unique_ptr<Checkpoint<NX,NY,NZ,DdQq>> Backup;
+        if (batch == false)
+        {
+            Backup.reset(new Checkpoint<NX,NY,NZ,DdQq>(Micro, CHECKPOINT_INTERVAL, CHECKPOINT_KEEP));
+        }
+
+        /// main loop ------------------------------------------------------------------------------
+        if (batch == false)
+        {
+            std::cout << "Simulation started..." << std::endl;
+        }
+
+        Timer Stopwatch;
+        Stopwatch.Start();
+
+        size_t i = 0;
+        for (i = 0; i < current.NT_; i+=2)
+        {
+            // even time step
+            if constexpr (WALL_FUNCTION == true)
+            {
+                WallFunction<false>(FrontWall,  Micro);
+                WallFunction<false>(BackWall,   Micro);
+                WallFunction<false>(BottomWall, Micro);
+                WallFunction<false>(TopWall,    Micro);
+            }
+            Guo<false,type::Velocity,orientation::Left>(Inlet,  Micro, 0);
+            Convective<false>(Outlet, Micro, Outflow, 0);
+            Statistics<NX,NY,NZ,F_TYPE>* const statsEven = Stats.Sample(i);
+            Micro.SweepSlabs([&](unsigned int const block_begin, unsigned int const block_end)
+            {
+                CollideStreamBGK_Smagorinsky<false>(Macro, Micro, 0, block_begin, block_end, statsEven, nullptr, &Layer);
+            });
+            BounceBackBouzidi<false>(Curved, Micro, Forces);
+            Forces.Export(i+1);
+
+            // odd time step
+            Monitor<NX,NY,NZ,F_TYPE>* const monitor = Diagnostics.Sample(i+2);
+            if constexpr (WALL_FUNCTION == true)
+            {
+                WallFunction<true>(FrontWall,  Micro);
+                WallFunction<true>(BackWall,   Micro);
+                WallFunction<true>(BottomWall, Micro);
+                WallFunction<true>(TopWall,    Micro);
+            }
+            Guo<true,type::Velocity,orientation::Left>(Inlet, Micro, 0);
+            Convective<true>(Outlet, Micro, Outflow, 0);
+            Statistics<NX,NY,NZ,F_TYPE>* const statsOdd = Stats.Sample(i+1);
+            Micro.SweepSlabs([&](unsigned int const block_begin, unsigned int const block_end)
+            {
+                CollideStreamBGK_Smagorinsky<true>(Macro, Micro, 0, block_begin, block_end, statsOdd, nullptr, &Layer, monitor);
+            });
+            BounceBackBouzidi<true>(Curved, Micro, Forces);
+            Forces.Export(i+2);
+
+            if (save == true)
+            {
+                Probes.Sample<false>(i+2);
+            }
+
+            if (monitor != nullptr)
+            {
+                if (Diagnostics.Update(i+2) == true)
+                {
+                    if (batch == false)
+                    {
+                        std::cout << "Steady state reached after " << i+2 << " time steps." << std::endl;
+                    }
+                    i += 2;
+                    break;
+                }
+            }
+
+            if ((output == true) && (i % (current.NT_/10) == 0))
+            {
+                StatusOutput(i, current.NT_);
+                ComputeMacroscopic<false>(Macro, Micro, 0);
+                Macro.SetZero(wall);
+                //Macro.Export("step",i);
+                Macro.ExportVtk(i);
+            }
+
+            if ((Backup != nullptr) && (Backup->Update(i+2) == true))
+            {
+                i += 2;
+                break;
+            }
+        }
+
+        runtime = Stopwatch.Stop();
+
+        if (batch == false)
+        {
+            PerformanceOutput(Macro, Micro, i, current.NT_, Stopwatch.GetRuntime());
+        }
+
+        /// final export ---------------------------------------------------------------------------
+        if (save == true)
+        {
+            Stats.ExportVtk(prefix + "statistics");
+        }
+
+        /*Macro.SetZero(wall);
+        Macro.Export("step",NT);
+        Macro.ExportVtk(NT);
+        Macro.ExportScalarVtk(0,"rho",NT);*/
+
+        return i;
+    };
+
+    /// parameter study: cases run concurrently on nested teams sharing the geometry ---------------
+    if (batch == true)
+    {
+        std::vector<Case> const cases = ReadCases(batchList);
+
+        #ifdef _OPENMP
+            OpenMP.SetNestedParallelism(true);
+        #endif
+        RunBatch(cases, batchConcurrent, static_cast<double>(NX)*NY*NZ, Simulation);
+    }
+    else
+    {
+        double runtime = 0.0;
+        Simulation(Case{"", Re, U, NT}, runtime);
+    }
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,109 @@
+#ifndef BLOCK_ORDER_HPP_INCLUDED
+#define BLOCK_ORDER_HPP_INCLUDED
+
+/**
+ * \file     block_order.hpp
+ * \mainpage Space-filling curve ordering of the loop blocks
+ *
+ * \note     The loop blocks are numbered lexicographically (x fastest) but swept in the order of a
+ *           Morton (Z-order) curve: the bits of the block coordinates are interleaved and the blocks
+ *           are sorted by the resulting key, which also covers numbers of blocks that are no power of
+ *           two. Every thread sweeps one contiguous part of the curve with equal estimated cost
+ *           (BlockSchedule::Begin), so the blocks of a thread form a spatially compact region and
+ *           consecutive blocks are neighbours: the neighbour accesses of the odd time steps hit
+ *           populations that were recently loaded into the cache. All sweeps and the initialisation
+ *           use the same order and partition so that every block is first touched by the thread
+ *           that processes it (until measured costs shift the boundaries of the parts).
+ *           Out-of-core populations are swept slab by slab in z-direction: the blocks of every slab
+ *           are contiguous and only ordered along a two-dimensional curve within the slab.
+*/
+
+#include <algorithm>
+#include <numeric>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include "../general/constexpr_func.hpp"
+
+
+/**\class  BlockOrder
+ * \brief  Permutation of the loop blocks along a Morton curve
+ *
+ * \tparam NX           simulation domain resolution in x-direction
+ * \tparam NY           simulation domain resolution in y-direction
+ * \tparam NZ           simulation domain resolution in z-direction
+ * \tparam BLOCK_SIZE   loop block size of the population
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, unsigned int BLOCK_SIZE>
+class BlockOrder
+{
+    public:
+        static constexpr unsigned int NUM_BLOCKS_Z_ = cef::ceil(static_cast<double>(NZ) / BLOCK_SIZE);
+        static constexpr unsigned int NUM_BLOCKS_Y_ = cef::ceil(static_cast<double>(NY) / BLOCK_SIZE);
+        static constexpr unsigned int NUM_BLOCKS_X_ = cef::ceil(static_cast<double>(NX) / BLOCK_SIZE);
+        static constexpr unsigned int   NUM_BLOCKS_ = NUM_BLOCKS_X_*NUM_BLOCKS_Y_*NUM_BLOCKS_Z_;
+
+        /**\brief     Class constructor
+         *
+         * \param[in] slabs   keep the slabs in z-direction contiguous (out-of-core sweeps)
+        */
+        BlockOrder(bool const slabs = false):
+            order_(NUM_BLOCKS_)
+        {
+            // sort key: slab and position along the curve
+            std::vector<std::pair<unsigned int,uint64_t>> key(NUM_BLOCKS_);
+            for(unsigned int block = 0; block < NUM_BLOCKS_; ++block)
+            {
+                unsigned int const z = block / (NUM_BLOCKS_X_*NUM_BLOCKS_Y_);
+                unsigned int const y = (block % (NUM_BLOCKS_X_*NUM_BLOCKS_Y_)) / NUM_BLOCKS_X_;
+                unsigned int const x = block % NUM_BLOCKS_X_;
+
+                key[block] = (slabs == true) ? std::make_pair(z, Interleave(x, y, 0))
+                                             : std::make_pair(0u, Interleave(x, y, z));
+            }
+
+            std::iota(order_.begin(), order_.end(), 0);
+            std::stable_sort(order_.begin(), order_.end(), [&key](unsigned int const a, unsigned int const b)
+            {
+                return key[a] < key[b];
+            });
+        }
+
+        /**\fn        Block
+         * \brief     Lexicographic index of a loop block
+         * \warning   Inline function! Called from within the kernels.
+         *
+         * \param[in] i   position of the block along the curve
+         * \return    Index of the block: x fastest, then y and z
+        */
+        inline unsigned int __attribute__((always_inline)) Block(unsigned int const i) const
+        {
+            return order_[i];
+        }
+
+    private:
+        std::vector<unsigned int> order_;   ///< lexicographic index of the blocks along the curve
+
+        /**\fn        Interleave
+         * \brief     Morton key: interleave the bits of the block coordinates (21 bit each)
+         *
+         * \param[in] x   block coordinate in x-direction
+         * \param[in] y   block coordinate in y-direction
+         * \param[in] z   block coordinate in z-direction
+         * \return    Bits of the coordinates in the order ...z1 y1 x1 z0 y0 x0
+        */
+        static uint64_t Interleave(unsigned int const x, unsigned int const y, unsigned int const z)
+        {
+            uint64_t key = 0;
+            for(unsigned int bit = 0; bit < 21; ++bit)
+            {
+                key |= ((static_cast<uint64_t>(x) >> bit) & 1) << (3*bit + 0);
+                key |= ((static_cast<uint64_t>(y) >> bit) & 1) << (3*bit + 1);
+                key |= ((static_cast<uint64_t>(z) >> bit) & 1) << (3*bit + 2);
+            }
+            return key;
+        }
+};
+
+#endif // BLOCK_ORDER_HPP_INCLUDED
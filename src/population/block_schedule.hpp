@@ -0,0 +1,191 @@
+#ifndef BLOCK_SCHEDULE_HPP_INCLUDED
+#define BLOCK_SCHEDULE_HPP_INCLUDED
+
+/**
+ * \file     block_schedule.hpp
+ * \mainpage Cost-weighted static partition of the loop blocks among the threads
+ *
+ * \note     The loop blocks differ widely in cost: completely solid blocks are skipped, blocks cut
+ *           by a geometry only hold a fraction of fluid cells and the cost of the collision depends
+ *           on the region (e.g. absorbing layers). Instead of distributing equal numbers of blocks
+ *           the curve of the block order is cut into one contiguous part per thread with equal
+ *           estimated cost, so that no thread waits at the implicit barrier for the slowest one and
+ *           every thread works on a spatially compact region. The cost of a block is estimated from
+ *           the geometry (fluid cells and scanned rows) or taken from the runtime of the blocks
+ *           measured by the kernels during the previous time steps.
+*/
+
+#include <algorithm>
+#include <vector>
+
+#include "../general/constexpr_func.hpp"
+
+
+/**\class  BlockSchedule
+ * \brief  Estimated cost of every loop block and its partition among the threads
+ *
+ * \tparam NX           simulation domain resolution in x-direction
+ * \tparam NY           simulation domain resolution in y-direction
+ * \tparam NZ           simulation domain resolution in z-direction
+ * \tparam BLOCK_SIZE   loop block size of the population
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, unsigned int BLOCK_SIZE>
+class BlockSchedule
+{
+    public:
+        static constexpr unsigned int NUM_BLOCKS_Z_ = cef::ceil(static_cast<double>(NZ) / BLOCK_SIZE);
+        static constexpr unsigned int NUM_BLOCKS_Y_ = cef::ceil(static_cast<double>(NY) / BLOCK_SIZE);
+        static constexpr unsigned int NUM_BLOCKS_X_ = cef::ceil(static_cast<double>(NX) / BLOCK_SIZE);
+        static constexpr unsigned int   NUM_BLOCKS_ = NUM_BLOCKS_X_*NUM_BLOCKS_Y_*NUM_BLOCKS_Z_;
+
+        static constexpr double ROW_COST_ = 1.0;    ///< cost of scanning a row of a block relative to a fluid cell
+
+        bool measure_ = false;                      ///< collision kernels record the runtime of every block
+
+        /**\brief Class constructor: equal cost of all blocks
+        */
+        BlockSchedule():
+            cost_(NUM_BLOCKS_, 1.0), time_(NUM_BLOCKS_, 0.0), prefix_(NUM_BLOCKS_ + 1, 0.0)
+        {
+            for(unsigned int k = 0; k <= NUM_BLOCKS_; ++k)
+            {
+                prefix_[k] = k;
+            }
+        }
+
+        /**\fn        Estimate
+         * \brief     Estimate the cost of every block from the geometry. Has to be called after the
+         *            cell flags are updated.
+         *
+         * \param[in] order   order in which the blocks are swept
+         * \param[in] flags   cell flags holding the solid cells and blocks
+        */
+        template <class Order, class Flags>
+        void Estimate(Order const& order, Flags const& flags)
+        {
+            #pragma omp parallel for default(none) shared(flags) schedule(static)
+            for(unsigned int block = 0; block < NUM_BLOCKS_; ++block)
+            {
+                if (flags.IsSolidBlock(block) == true)
+                {
+                    cost_[block] = 0.0;
+                    continue;
+                }
+
+                unsigned int const z_start = BLOCK_SIZE * (block / (NUM_BLOCKS_X_*NUM_BLOCKS_Y_));
+                unsigned int const   z_end = std::min(z_start + BLOCK_SIZE, NZ);
+                unsigned int const y_start = BLOCK_SIZE*((block % (NUM_BLOCKS_X_*NUM_BLOCKS_Y_)) / NUM_BLOCKS_X_);
+                unsigned int const   y_end = std::min(y_start + BLOCK_SIZE, NY);
+                unsigned int const x_start = BLOCK_SIZE*(block % NUM_BLOCKS_X_);
+                unsigned int const   x_end = std::min(x_start + BLOCK_SIZE, NX);
+
+                double cost = 0.0;
+                for(unsigned int z = z_start; z < z_end; ++z)
+                {
+                    for(unsigned int y = y_start; y < y_end; ++y)
+                    {
+                        cost += ROW_COST_;
+                        for(unsigned int x = flags.NextFluid(x_start, y, z, x_end); x < x_end; x = flags.NextFluid(x + 1, y, z, x_end))
+                        {
+                            cost += 1.0;
+                        }
+                    }
+                }
+                cost_[block] = cost;
+            }
+
+            Accumulate(order);
+        }
+
+        /**\fn        Reset
+         * \brief     Equal cost of all blocks: equal numbers of blocks per thread
+         *
+         * \param[in] order   order in which the blocks are swept
+        */
+        template <class Order>
+        void Reset(Order const& order)
+        {
+            std::fill(cost_.begin(), cost_.end(), 1.0);
+            std::fill(time_.begin(), time_.end(), 0.0);
+            Accumulate(order);
+        }
+
+        /**\fn        Record
+         * \brief     Add the measured runtime of a block
+         * \warning   Inline function! Called from within the kernels.
+         *
+         * \param[in] block     index of the loop block
+         * \param[in] seconds   runtime of the block
+        */
+        inline void __attribute__((always_inline)) Record(unsigned int const block, double const seconds)
+        {
+            time_[block] += seconds;
+        }
+
+        /**\fn        Adapt
+         * \brief     Replace the cost of the blocks by the runtime recorded since the last call and
+         *            repartition the blocks. Has to be called outside of the kernels.
+         *
+         * \param[in] order   order in which the blocks are swept
+        */
+        template <class Order>
+        void Adapt(Order const& order)
+        {
+            if (std::any_of(time_.begin(), time_.end(), [](double const t){ return t > 0.0; }) == false)
+            {
+                return;
+            }
+
+            cost_.swap(time_);
+            std::fill(time_.begin(), time_.end(), 0.0);
+            Accumulate(order);
+        }
+
+        /**\fn        Begin
+         * \brief     First block of a part of a range of the block order
+         * \warning   Inline function! Called from within the kernels.
+         *
+         * \param[in] part    index of the part (parts: end of the range)
+         * \param[in] parts   number of parts (threads)
+         * \param[in] begin   first position of the range along the block order
+         * \param[in] end     position after the last one of the range
+         * \return    Position of the first block of the part along the block order
+        */
+        inline unsigned int __attribute__((always_inline)) Begin(unsigned int const part, unsigned int const parts,
+                                                                 unsigned int const begin, unsigned int const end) const
+        {
+            if (part == 0)
+            {
+                return begin;
+            }
+            if (part >= parts)
+            {
+                return end;
+            }
+
+            double const target = prefix_[begin] + (prefix_[end] - prefix_[begin])*part/parts;
+            return static_cast<unsigned int>(std::lower_bound(prefix_.begin() + begin, prefix_.begin() + end, target) - prefix_.begin());
+        }
+
+    private:
+        std::vector<double> cost_;      ///< estimated cost of every block (lexicographic index)
+        std::vector<double> time_;      ///< runtime recorded since the last adaption
+        std::vector<double> prefix_;    ///< cost of all blocks before a position along the block order
+
+        /**\fn        Accumulate
+         * \brief     Prefix sum of the cost along the block order
+         *
+         * \param[in] order   order in which the blocks are swept
+        */
+        template <class Order>
+        void Accumulate(Order const& order)
+        {
+            prefix_[0] = 0.0;
+            for(unsigned int k = 0; k < NUM_BLOCKS_; ++k)
+            {
+                prefix_[k + 1] = prefix_[k] + cost_[order.Block(k)];
+            }
+        }
+};
+
+#endif // BLOCK_SCHEDULE_HPP_INCLUDED
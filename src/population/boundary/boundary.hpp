@@ -25,6 +25,9 @@ struct boundaryElement
     T const u;   // velocity in x-direction
     T const v;   // velocity in y-direction
     T const w;   // velocity in z-direction
+
+    /// tag of the solid body the element belongs to (e.g. for force evaluation)
+    unsigned int const body = 0;
 };
 
 #endif // BOUNDARY_HPP_INCLUDED
@@ -6,11 +6,15 @@
  * \mainpage Solid walls with simple bounce-back boundaries
 */
 
+#include <vector>
 #if __has_include (<omp.h>)
     #include <omp.h>
 #endif
 
 #include "boundary.hpp"
+#include "boundary_links.hpp"
+#include "boundary_list.hpp"
+#include "boundary_momentum.hpp"
 #include "../population.hpp"
 
 
@@ -27,28 +31,174 @@
  * \tparam     NY     simulation domain resolution in y-direction
  * \tparam     NZ     simulation domain resolution in z-direction
  * \tparam     LT     static lattice::DdQq class containing discretisation parameters
- * \tparam     T      floating data type used for simulation
- * \param[in]  wall   vector holding all corresponding boundary condition elements
+ * \tparam     NPOP   number of populations stored side by side in the lattice
+ * \param[in]  wall   compact list holding all corresponding boundary nodes
  * \param[out] pop    population object holding microscopic variables
  * \param[in]  p      relevant population (default = 0)
 */
-template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, typename T>
-void BounceBackHalfway(std::vector<boundaryElement<T>> const& wall, Population<NX,NY,NZ,LT>& pop, unsigned int const p = 0)
+template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP>
+void BounceBackHalfway(BoundaryList<NX,NY,NZ,LT,orientation::None,NPOP> const& wall, Population<NX,NY,NZ,LT,NPOP>& pop, unsigned int const p = 0)
 {
     #pragma omp parallel for default(none) shared(wall,pop,p) schedule(static,32)
-    for(size_t i = 0; i < wall.size(); ++i)
+    for(size_t i = 0; i < wall.SIZE_; ++i)
     {
-        unsigned int const x_n[3] = { (NX + wall[i].x - 1) % NX, wall[i].x, (wall[i].x + 1) % NX };
-        unsigned int const y_n[3] = { (NY + wall[i].y - 1) % NY, wall[i].y, (wall[i].y + 1) % NY };
-        unsigned int const z_n[3] = { (NZ + wall[i].z - 1) % NZ, wall[i].z, (wall[i].z + 1) % NZ };
-
         #pragma GCC unroll (2)
         for(unsigned int n = 0; n <= 1; ++n)
         {
             #pragma GCC unroll (15)
             for(unsigned int d = 1; d < LT::HSPEED; ++d)
             {
-                pop.F_[pop. template AA_IndexWrite<odd>(x_n, y_n, z_n, !n, d, p)] = pop.F_[pop. template AA_IndexRead<!odd>(x_n, y_n, z_n, n, d, p)];
+                pop.F_[wall. template IndexWrite<odd>(i, !n, d, p)] = pop.F_[wall. template IndexRead<!odd>(i, n, d, p)];
+            }
+        }
+    }
+}
+
+/**\fn            BounceBackHalfway
+ * \brief         Solid wall boundary treatment with simple halfway bounce-back fused with the
+ *                evaluation of the forces on all tagged bodies by momentum exchange
+ *
+ * \tparam        odd      even (0, false) or odd (1, true) time step
+ * \tparam        NX       simulation domain resolution in x-direction
+ * \tparam        NY       simulation domain resolution in y-direction
+ * \tparam        NZ       simulation domain resolution in z-direction
+ * \tparam        LT       static lattice::DdQq class containing discretisation parameters
+ * \param[in]     wall     compact list holding all corresponding boundary nodes
+ * \param[out]    pop      population object holding microscopic variables
+ * \param[in,out] forces   links of the wall elements and resulting forces on the bodies
+ * \param[in]     p        relevant population (default = 0)
+*/
+template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT>
+void BounceBackHalfway(BoundaryList<NX,NY,NZ,LT> const& wall, Population<NX,NY,NZ,LT>& pop,
+                       MomentumExchange<NX,NY,NZ,LT>& forces, unsigned int const p = 0)
+{
+    typedef typename Population<NX,NY,NZ,LT>::T T;
+
+    std::fill(forces.force_.begin(), forces.force_.end(), static_cast<T>(0.0));
+
+    #pragma omp parallel default(none) shared(wall,pop,forces,p)
+    {
+        /// thread-local force on every body
+        std::vector<T> force(forces.force_.size(), static_cast<T>(0.0));
+
+        #pragma omp for schedule(static,32) nowait
+        for(size_t i = 0; i < wall.SIZE_; ++i)
+        {
+            uint64_t const links = forces.links_[i];
+            T fx = 0.0;
+            T fy = 0.0;
+            T fz = 0.0;
+
+            #pragma GCC unroll (2)
+            for(unsigned int n = 0; n <= 1; ++n)
+            {
+                #pragma GCC unroll (15)
+                for(unsigned int d = 1; d < LT::HSPEED; ++d)
+                {
+                    unsigned int const curr = n*LT::OFF + d;
+                    T const f = pop.F_[wall. template IndexRead<!odd>(i, n, d, p)];
+                    pop.F_[wall. template IndexWrite<odd>(i, !n, d, p)] = f;
+
+                    T const exchange = ((links >> curr) & 1) ? 2.0*f : 0.0;
+                    fx += exchange*LT::DX[curr];
+                    fy += exchange*LT::DY[curr];
+                    fz += exchange*LT::DZ[curr];
+                }
+            }
+
+            force[3*wall.body_[i] + 0] += fx;
+            force[3*wall.body_[i] + 1] += fy;
+            force[3*wall.body_[i] + 2] += fz;
+        }
+
+        #pragma omp critical
+        {
+            for(size_t b = 0; b < force.size(); ++b)
+            {
+                forces.force_[b] += force[b];
+            }
+        }
+    }
+}
+
+/**\fn         BounceBackHalfway
+ * \brief      Solid wall boundary treatment with simple halfway bounce-back along the links between
+ *             fluid and solid cells only
+ *
+ * \tparam     odd     even (0, false) or odd (1, true) time step
+ * \tparam     NX      simulation domain resolution in x-direction
+ * \tparam     NY      simulation domain resolution in y-direction
+ * \tparam     NZ      simulation domain resolution in z-direction
+ * \tparam     LT      static lattice::DdQq class containing discretisation parameters
+ * \param[in]  links   list holding all links between fluid and solid cells (slot indices of a single
+ *                     population)
+ * \param[out] pop     population object holding microscopic variables
+*/
+template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT>
+void BounceBackHalfway(LinkList<NX,NY,NZ,LT> const& links, Population<NX,NY,NZ,LT>& pop)
+{
+    typedef typename Population<NX,NY,NZ,LT>::T T;
+
+    size_t const* const src = odd ? links.solid_.data() : links.fluid_.data();
+    size_t const* const dst = odd ? links.fluid_.data() : links.solid_.data();
+    T* const F = pop.F_;
+
+    #pragma omp parallel for simd default(none) shared(links) firstprivate(src,dst,F) schedule(static)
+    for(size_t l = 0; l < links.SIZE_; ++l)
+    {
+        F[dst[l]] = F[src[l]];
+    }
+}
+
+/**\fn            BounceBackHalfway
+ * \brief         Solid wall boundary treatment with simple halfway bounce-back along the links between
+ *                fluid and solid cells fused with the evaluation of the forces on all tagged bodies by
+ *                momentum exchange
+ *
+ * \tparam        odd      even (0, false) or odd (1, true) time step
+ * \tparam        NX       simulation domain resolution in x-direction
+ * \tparam        NY       simulation domain resolution in y-direction
+ * \tparam        NZ       simulation domain resolution in z-direction
+ * \tparam        LT       static lattice::DdQq class containing discretisation parameters
+ * \param[in]     links    list holding all links between fluid and solid cells (slot indices of a
+ *                         single population)
+ * \param[out]    pop      population object holding microscopic variables
+ * \param[in,out] forces   resulting forces on the bodies
+*/
+template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT>
+void BounceBackHalfway(LinkList<NX,NY,NZ,LT> const& links, Population<NX,NY,NZ,LT>& pop,
+                       MomentumExchange<NX,NY,NZ,LT>& forces)
+{
+    typedef typename Population<NX,NY,NZ,LT>::T T;
+
+    size_t const* const src = odd ? links.solid_.data() : links.fluid_.data();
+    size_t const* const dst = odd ? links.fluid_.data() : links.solid_.data();
+    T* const F = pop.F_;
+
+    std::fill(forces.force_.begin(), forces.force_.end(), static_cast<T>(0.0));
+
+    #pragma omp parallel default(none) shared(links,forces) firstprivate(src,dst,F)
+    {
+        /// thread-local force on every body
+        std::vector<T> force(forces.force_.size(), static_cast<T>(0.0));
+
+        #pragma omp for schedule(static) nowait
+        for(size_t l = 0; l < links.SIZE_; ++l)
+        {
+            T const f = F[src[l]];
+            F[dst[l]] = f;
+
+            unsigned int const curr = links.link_[l];
+            force[3*links.body_[l] + 0] += 2.0*f*LT::DX[curr];
+            force[3*links.body_[l] + 1] += 2.0*f*LT::DY[curr];
+            force[3*links.body_[l] + 2] += 2.0*f*LT::DZ[curr];
+        }
+
+        #pragma omp critical
+        {
+            for(size_t b = 0; b < force.size(); ++b)
+            {
+                forces.force_[b] += force[b];
             }
         }
     }
@@ -0,0 +1,242 @@
+#ifndef BOUNDARY_BOUZIDI_HPP_INCLUDED
+#define BOUNDARY_BOUZIDI_HPP_INCLUDED
+
+/**
+ * \file     boundary_bouzidi.hpp
+ * \mainpage Solid walls with interpolated bounce-back boundaries
+ * \note     "Momentum transfer of a Boltzmann-lattice fluid with boundaries"
+ *           M. Bouzidi, M. Firdaouss, P. Lallemand
+ *           Physics of Fluids 13 (2001)
+ *           DOI: 10.1063/1.1399290
+ *
+ *           The wall cuts the link between the fluid cell x_f and the solid cell x_f + c_i at the
+ *           relative distance q from x_f. The population entering x_f is interpolated linearly:
+ *           q <  1/2: f_-i(x_f) = 2q f_i(x_f) + (1 - 2q) f_i(x_f - c_i)
+ *           q >= 1/2: f_-i(x_f) = 1/(2q) f_i(x_f) + (2q - 1)/(2q) f_-i(x_f)
+ *           with the post-collision populations on the right hand side. With the A-A access pattern
+ *           the four populations of a link are found in fixed slots that only swap their roles
+ *           between even and odd time steps, so every link is reduced to a weighted sum of three
+ *           populations with precomputed indices and weights.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "boundary_links.hpp"
+#include "boundary_momentum.hpp"
+#include "../population.hpp"
+
+
+/**\class  BouzidiLinks
+ * \brief  Structure of arrays holding the links between fluid and solid cells with the indices of
+ *         all populations involved in the interpolation and the resulting weights
+ *
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+ * \tparam LT   static lattice::DdQq class containing discretisation parameters
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT>
+class BouzidiLinks
+{
+    public:
+        /// import current lattice floating data type
+        typedef typename std::remove_const<decltype(LT::CS)>::type T;
+
+        size_t const SIZE_;                 ///< number of links
+
+        std::vector<size_t>       fluid_;     ///< population i of the fluid cell x_f
+        std::vector<size_t>       solid_;     ///< population -i of the solid cell x_f + c_i
+        std::vector<size_t>       upstream_;  ///< population i of the fluid cell x_f - c_i
+        std::vector<size_t>       opposite_;  ///< population -i of the fluid cell x_f
+        std::vector<T>            weight_[3]; ///< weights of f_i(x_f), f_i(x_f - c_i) and f_-i(x_f)
+        std::vector<T>            q_;         ///< relative wall distance
+        std::vector<unsigned int> link_;      ///< lattice velocity i = n*OFF + d of the link
+        std::vector<unsigned int> body_;      ///< tag of the solid body the link belongs to
+
+        /**\brief     Class constructor: evaluates the wall distance of every link in parallel and
+         *            precomputes the interpolation. Links whose upstream cell x_f - c_i is solid fall
+         *            back to halfway bounce-back (q = 1/2).
+         *
+         * \tparam    Distance   callable with the signature T(x, y, z, cx, cy, cz, body) returning the
+         *                       relative distance q in (0,1] of the wall along the link from the fluid
+         *                       cell (x,y,z) in direction (cx,cy,cz) to the solid body with the given tag
+         * \param[in] links      list holding all links between fluid and solid cells
+         * \param[in] pop        population object holding the cell types
+         * \param[in] distance   wall distance of a link (analytic or from a voxelized geometry)
+        */
+        template <typename Distance>
+        BouzidiLinks(LinkList<NX,NY,NZ,LT> const& links, Population<NX,NY,NZ,LT> const& pop, Distance const& distance):
+            BouzidiLinks(links, pop.flags_, distance)
+        {
+        }
+
+        /**\brief     Class constructor: interpolation from cell types that are not (yet) held by a
+         *            population, e.g. a geometry shared by several simulations
+         *
+         * \tparam    BLOCK_SIZE   loop block size of the cell types
+         * \tparam    Distance     callable returning the relative wall distance of a link (see above)
+         * \param[in] links        list holding all links between fluid and solid cells
+         * \param[in] flags        cell types of the domain
+         * \param[in] distance     wall distance of a link (analytic or from a voxelized geometry)
+        */
+        template <unsigned int BLOCK_SIZE, typename Distance>
+        BouzidiLinks(LinkList<NX,NY,NZ,LT> const& links, CellFlags<NX,NY,NZ,BLOCK_SIZE> const& flags, Distance const& distance):
+            SIZE_(links.SIZE_), fluid_(links.fluid_), solid_(links.solid_), upstream_(SIZE_), opposite_(SIZE_),
+            weight_{std::vector<T>(SIZE_), std::vector<T>(SIZE_), std::vector<T>(SIZE_)}, q_(SIZE_),
+            link_(links.link_), body_(links.body_)
+        {
+            #pragma omp parallel for default(none) shared(flags,distance) schedule(static)
+            for(size_t l = 0; l < SIZE_; ++l)
+            {
+                unsigned int const curr = link_[l];
+                unsigned int const    n = curr / LT::OFF;
+                unsigned int const    d = curr % LT::OFF;
+                size_t const       cell = (fluid_[l] - curr) / LT::ND;
+
+                unsigned int const x = cell % NX;
+                unsigned int const y = (cell / NX) % NY;
+                unsigned int const z = cell / (static_cast<size_t>(NX)*NY);
+                int const cx = static_cast<int>(LT::DX[curr]);
+                int const cy = static_cast<int>(LT::DY[curr]);
+                int const cz = static_cast<int>(LT::DZ[curr]);
+
+                unsigned int const x_u = (NX + x - cx) % NX;
+                unsigned int const y_u = (NY + y - cy) % NY;
+                unsigned int const z_u = (NZ + z - cz) % NZ;
+
+                T q = static_cast<T>(0.5);
+                if (flags.Is(x_u, y_u, z_u, SOLID) == false)
+                {
+                    q = std::min(std::max(static_cast<T>(distance(x, y, z, cx, cy, cz, body_[l])), static_cast<T>(1.0e-3)), static_cast<T>(1.0));
+                }
+                q_[l] = q;
+
+                upstream_[l] = ((static_cast<size_t>(z_u)*NY + y_u)*NX + x_u)*LT::ND + curr;
+                opposite_[l] = cell*LT::ND + (!n)*LT::OFF + d;
+
+                if (q < static_cast<T>(0.5))
+                {
+                    weight_[0][l] = 2.0*q;
+                    weight_[1][l] = 1.0 - 2.0*q;
+                    weight_[2][l] = 0.0;
+                }
+                else
+                {
+                    weight_[0][l] = 1.0/(2.0*q);
+                    weight_[1][l] = 0.0;
+                    weight_[2][l] = (2.0*q - 1.0)/(2.0*q);
+                }
+
+                // halfway bounce-back: do not touch any other population
+                if (std::abs(q - static_cast<T>(0.5)) <= std::numeric_limits<T>::epsilon())
+                {
+                    upstream_[l] = fluid_[l];
+                    opposite_[l] = fluid_[l];
+                }
+            }
+        }
+};
+
+
+/**\fn         BounceBackBouzidi
+ * \brief      Solid wall boundary treatment with linearly interpolated bounce-back
+ *
+ * \tparam     odd     even (0, false) or odd (1, true) time step
+ * \tparam     NX      simulation domain resolution in x-direction
+ * \tparam     NY      simulation domain resolution in y-direction
+ * \tparam     NZ      simulation domain resolution in z-direction
+ * \tparam     LT      static lattice::DdQq class containing discretisation parameters
+ * \param[in]  links   list holding all links between fluid and solid cells with their interpolation
+ *                     (slot indices of a single population)
+ * \param[out] pop     population object holding microscopic variables
+*/
+template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT>
+void BounceBackBouzidi(BouzidiLinks<NX,NY,NZ,LT> const& links, Population<NX,NY,NZ,LT>& pop)
+{
+    typedef typename Population<NX,NY,NZ,LT>::T T;
+
+    /// after odd steps the post-collision populations are found in the opposite slots
+    size_t const* const dst = odd ? links.fluid_.data()    : links.solid_.data();
+    size_t const* const src = odd ? links.solid_.data()    : links.fluid_.data();
+    size_t const* const ups = odd ? links.opposite_.data() : links.upstream_.data();
+    size_t const* const opp = odd ? links.upstream_.data() : links.opposite_.data();
+    T const* const w0 = links.weight_[0].data();
+    T const* const w1 = links.weight_[1].data();
+    T const* const w2 = links.weight_[2].data();
+    T* const F = pop.F_;
+
+    #pragma omp parallel for simd default(none) shared(links) firstprivate(dst,src,ups,opp,w0,w1,w2,F) schedule(static)
+    for(size_t l = 0; l < links.SIZE_; ++l)
+    {
+        F[dst[l]] = w0[l]*F[src[l]] + w1[l]*F[ups[l]] + w2[l]*F[opp[l]];
+    }
+}
+
+/**\fn            BounceBackBouzidi
+ * \brief         Solid wall boundary treatment with linearly interpolated bounce-back fused with the
+ *                evaluation of the forces on all tagged bodies by momentum exchange
+ * \note          The momentum transferred along a link is (f_i + f_-i) c_i with the outgoing
+ *                post-collision and the interpolated incoming population.
+ *
+ * \tparam        odd      even (0, false) or odd (1, true) time step
+ * \tparam        NX       simulation domain resolution in x-direction
+ * \tparam        NY       simulation domain resolution in y-direction
+ * \tparam        NZ       simulation domain resolution in z-direction
+ * \tparam        LT       static lattice::DdQq class containing discretisation parameters
+ * \param[in]     links    list holding all links between fluid and solid cells with their interpolation
+ *                         (slot indices of a single population)
+ * \param[out]    pop      population object holding microscopic variables
+ * \param[in,out] forces   resulting forces on the bodies
+*/
+template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT>
+void BounceBackBouzidi(BouzidiLinks<NX,NY,NZ,LT> const& links, Population<NX,NY,NZ,LT>& pop,
+                       MomentumExchange<NX,NY,NZ,LT>& forces)
+{
+    typedef typename Population<NX,NY,NZ,LT>::T T;
+
+    size_t const* const dst = odd ? links.fluid_.data()    : links.solid_.data();
+    size_t const* const src = odd ? links.solid_.data()    : links.fluid_.data();
+    size_t const* const ups = odd ? links.opposite_.data() : links.upstream_.data();
+    size_t const* const opp = odd ? links.upstream_.data() : links.opposite_.data();
+    T const* const w0 = links.weight_[0].data();
+    T const* const w1 = links.weight_[1].data();
+    T const* const w2 = links.weight_[2].data();
+    T* const F = pop.F_;
+
+    std::fill(forces.force_.begin(), forces.force_.end(), static_cast<T>(0.0));
+
+    #pragma omp parallel default(none) shared(links,forces) firstprivate(dst,src,ups,opp,w0,w1,w2,F)
+    {
+        /// thread-local force on every body
+        std::vector<T> force(forces.force_.size(), static_cast<T>(0.0));
+
+        #pragma omp for schedule(static) nowait
+        for(size_t l = 0; l < links.SIZE_; ++l)
+        {
+            T const f_out = F[src[l]];
+            T const f_in  = w0[l]*f_out + w1[l]*F[ups[l]] + w2[l]*F[opp[l]];
+            F[dst[l]] = f_in;
+
+            unsigned int const curr = links.link_[l];
+            force[3*links.body_[l] + 0] += (f_out + f_in)*LT::DX[curr];
+            force[3*links.body_[l] + 1] += (f_out + f_in)*LT::DY[curr];
+            force[3*links.body_[l] + 2] += (f_out + f_in)*LT::DZ[curr];
+        }
+
+        #pragma omp critical
+        {
+            for(size_t b = 0; b < force.size(); ++b)
+            {
+                forces.force_[b] += force[b];
+            }
+        }
+    }
+}
+
+#endif // BOUNDARY_BOUZIDI_HPP_INCLUDED
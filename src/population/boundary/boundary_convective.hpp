@@ -0,0 +1,111 @@
+#ifndef BOUNDARY_CONVECTIVE_HPP_INCLUDED
+#define BOUNDARY_CONVECTIVE_HPP_INCLUDED
+
+/**
+ * \file     boundary_convective.hpp
+ * \mainpage Non-reflecting convective outflow boundary condition
+ * \note     "Convective outflow boundary conditions in the lattice Boltzmann method"
+ *           Q. Lou, Z. Guo, B. Shi
+ *           Physical Review E 87 (2013)
+ *           DOI: 10.1103/PhysRevE.87.063301
+ *
+ *           The populations are transported out of the domain by the convective equation
+ *           df/dt + U df/dn = 0 that is discretised implicitly in time and with first order
+ *           upwind differences in space:
+ *           f_i(x_b, t+1) = (f_i(x_b, t) + U f_i(x_b - n, t+1)) / (1 + U)
+ *           Contrary to a pressure boundary vortices leave the domain without being reflected.
+*/
+
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "boundary_list.hpp"
+#include "../population.hpp"
+
+
+/**\class  ConvectiveOutflow
+ * \brief  Populations of all nodes of a convective outflow boundary of the previous time step
+ *
+ * \tparam NX            simulation domain resolution in x-direction
+ * \tparam NY            simulation domain resolution in y-direction
+ * \tparam NZ            simulation domain resolution in z-direction
+ * \tparam LT            static lattice::DdQq class containing discretisation parameters
+ * \tparam Orientation   boundary orientation (e.g. orientation::Right)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class Orientation>
+class ConvectiveOutflow
+{
+    public:
+        /// import current lattice floating data type
+        typedef typename std::remove_const<decltype(LT::CS)>::type T;
+
+        T const VELOCITY_;      ///< convection velocity normal to the boundary in lattice units
+
+        std::vector<T> f_;      ///< populations of the boundary nodes of the previous time step
+        bool           init_;   ///< populations of the previous time step are available
+
+        /**\brief     Class constructor
+         *
+         * \param[in] boundary   compact list holding all nodes of the outflow boundary
+         * \param[in] velocity   convection velocity in lattice units (e.g. mean outflow velocity)
+        */
+        ConvectiveOutflow(BoundaryList<NX,NY,NZ,LT,Orientation> const& boundary, T const velocity):
+            VELOCITY_(velocity), f_(boundary.SIZE_*LT::ND, 0.0), init_(false)
+        {
+        }
+};
+
+
+/**\fn            Convective
+ * \brief         Convective outflow boundary condition: overwrites all populations of the boundary
+ *                nodes with the solution of the convective equation
+ * \note          In the first time step the populations of the neighbour are copied (zero gradient).
+ *
+ * \tparam        odd           even (0, false) or odd (1, true) time step
+ * \tparam        Orientation   boundary orientation (e.g. orientation::Right)
+ * \tparam        NX            simulation domain resolution in x-direction
+ * \tparam        NY            simulation domain resolution in y-direction
+ * \tparam        NZ            simulation domain resolution in z-direction
+ * \tparam        LT            static lattice::DdQq class containing discretisation parameters
+ * \param[in]     boundary      compact list holding all nodes of the outflow boundary
+ * \param[out]    pop           population object holding microscopic variables
+ * \param[in,out] outflow       populations of the boundary nodes of the previous time step
+ * \param[in]     p             relevant population (default = 0)
+*/
+template <bool odd, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, class LT>
+void Convective(BoundaryList<NX,NY,NZ,LT,Orientation> const& boundary, Population<NX,NY,NZ,LT>& pop,
+                ConvectiveOutflow<NX,NY,NZ,LT,Orientation>& outflow, unsigned int const p = 0)
+{
+    typedef typename Population<NX,NY,NZ,LT>::T T;
+
+    static_assert(BoundaryList<NX,NY,NZ,LT,Orientation>::SHIFT_ == true, "Convective outflow requires an oriented boundary.");
+
+    T const     weight = outflow.VELOCITY_/(1.0 + outflow.VELOCITY_);
+    bool const    init = outflow.init_;
+    T* const  previous = outflow.f_.data();
+
+    #pragma omp parallel for default(none) shared(boundary,pop) firstprivate(p,weight,init,previous) schedule(static,32)
+    for(size_t i = 0; i < boundary.SIZE_; ++i)
+    {
+        #pragma GCC unroll (2)
+        for(unsigned int n = 0; n <= 1; ++n)
+        {
+            #pragma GCC unroll (16)
+            for(unsigned int d = n; d < LT::HSPEED; ++d)
+            {
+                unsigned int const curr = n*LT::OFF + d;
+                T const f_n = pop.F_[boundary. template SourceRead<odd>(i,n,d,p)];
+                T const f_b = (init == true) ? (1.0 - weight)*previous[i*LT::ND + curr] + weight*f_n : f_n;
+
+                previous[i*LT::ND + curr] = f_b;
+                pop.F_[boundary. template IndexRead<odd>(i,n,d,p)] = f_b;
+            }
+        }
+    }
+
+    outflow.init_ = true;
+}
+
+#endif // BOUNDARY_CONVECTIVE_HPP_INCLUDED
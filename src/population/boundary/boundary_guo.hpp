@@ -9,6 +9,7 @@
 #include <array>
 
 #include "boundary.hpp"
+#include "boundary_list.hpp"
 #include "boundary_orientation.hpp"
 #include "boundary_type.hpp"
 #include "../population.hpp"
@@ -30,28 +31,20 @@
  * \tparam     NY            simulation domain resolution in y-direction
  * \tparam     NZ            simulation domain resolution in z-direction
  * \tparam     LT            static lattice::DdQq class containing discretisation parameters
- * \tparam     T             floating data type used for simulation
- * \param[in]  boundary      vector holding all corresponding boundary condition elements
+ * \tparam     NPOP          number of populations stored side by side in the lattice
+ * \param[in]  boundary      compact list holding all corresponding boundary nodes
  * \param[out] pop           population object holding microscopic variables
  * \param[in]  p             relevant population (default = 0)
 */
-template <bool odd, template <class Orientation> class Type, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, typename T>
-void Guo(std::vector<boundaryElement<T>> const& boundary, Population<NX,NY,NZ,LT>& pop, unsigned int const p = 0)
+template <bool odd, template <class Orientation> class Type, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP>
+void Guo(BoundaryList<NX,NY,NZ,LT,Orientation,NPOP> const& boundary, Population<NX,NY,NZ,LT,NPOP>& pop, unsigned int const p = 0)
 {
+    typedef typename Population<NX,NY,NZ,LT,NPOP>::T T;
+
     #pragma omp parallel for default(none) shared(boundary,pop,p) schedule(static,32)
-    for(size_t i = 0; i < boundary.size(); ++i)
+    for(size_t i = 0; i < boundary.SIZE_; ++i)
     {
         /// for neighbouring cell
-        unsigned int const x_n[3] = { (NX + boundary[i].x + Orientation::x - 1) % NX,
-                                            boundary[i].x + Orientation::x,
-                                           (boundary[i].x + Orientation::x + 1) % NX };
-        unsigned int const y_n[3] = { (NY + boundary[i].y + Orientation::y - 1) % NY,
-                                            boundary[i].y + Orientation::y,
-                                           (boundary[i].y + Orientation::y + 1) % NY };
-        unsigned int const z_n[3] = { (NZ + boundary[i].z + Orientation::z - 1) % NZ,
-                                            boundary[i].z + Orientation::z,
-                                           (boundary[i].z + Orientation::z + 1) % NZ };
-
         // load distributions
         alignas(CACHE_LINE) T f[LT::ND] = {0.0};
 
@@ -61,7 +54,7 @@ void Guo(std::vector<boundaryElement<T>> const& boundary, Population<NX,NY,NZ,LT
             #pragma GCC unroll (16)
             for(unsigned int d = n; d < LT::HSPEED; ++d)
             {
-                f[n*LT::OFF + d] = pop.F_[pop. template AA_IndexRead<odd>(x_n,y_n,z_n,n,d,p)];
+                f[n*LT::OFF + d] = pop.F_[boundary. template SourceRead<odd>(i,n,d,p)];
             }
         }
 
@@ -106,10 +99,7 @@ void Guo(std::vector<boundaryElement<T>> const& boundary, Population<NX,NY,NZ,LT
 
         /// write to current node
         // set new macroscopic values
-        std::array<double,4> const bound  = {boundary[i].rho,
-                                             boundary[i].u,
-                                             boundary[i].v,
-                                             boundary[i].w};
+        std::array<double,4> const bound  = boundary.GetValues(i);
         std::array<double,4> const interp = {rho, u, v, w};
         std::array<double,4> res = Type<Orientation>::getMacroscopicValues(bound, interp);
         rho = res[0];
@@ -135,10 +125,6 @@ void Guo(std::vector<boundaryElement<T>> const& boundary, Population<NX,NY,NZ,LT
         }
 
         // write new population values to cell: feq + fneq
-        unsigned int const x_c[3] = { (NX + boundary[i].x - 1) % NX, boundary[i].x, (boundary[i].x + 1) % NX };
-        unsigned int const y_c[3] = { (NY + boundary[i].y - 1) % NY, boundary[i].y, (boundary[i].y + 1) % NY };
-        unsigned int const z_c[3] = { (NZ + boundary[i].z - 1) % NZ, boundary[i].z, (boundary[i].z + 1) % NZ };
-
         #pragma GCC unroll (2)
         for(unsigned int n = 0; n <= 1; ++n)
         {
@@ -146,7 +132,7 @@ void Guo(std::vector<boundaryElement<T>> const& boundary, Population<NX,NY,NZ,LT
             for(unsigned int d = n; d < LT::HSPEED; ++d)
             {
                 unsigned int const curr = n*LT::OFF + d;
-                pop.F_[pop. template AA_IndexRead<odd>(x_c,y_c,z_c,n,d,p)] = feq[curr] + fneq[curr];
+                pop.F_[boundary. template IndexRead<odd>(i,n,d,p)] = feq[curr] + fneq[curr];
             }
         }
     }
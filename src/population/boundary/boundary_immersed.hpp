@@ -0,0 +1,403 @@
+#ifndef BOUNDARY_IMMERSED_HPP_INCLUDED
+#define BOUNDARY_IMMERSED_HPP_INCLUDED
+
+/**
+ * \file     boundary_immersed.hpp
+ * \mainpage Immersed boundary method for moving and deforming bodies
+ * \note     "A direct-forcing fictitious domain method for particulate flows"
+ *           M. Uhlmann
+ *           Journal of Computational Physics 209 (2005)
+ *           DOI: 10.1016/j.jcp.2005.03.017
+ *
+ *           "An adaptive version of the immersed boundary method"
+ *           A.M. Roma, C.S. Peskin, M.J. Berger
+ *           Journal of Computational Physics 153 (1999)
+ *           DOI: 10.1006/jcph.1999.6293
+ *
+ *           The surface of a body is represented by Lagrangian markers that do not have to coincide
+ *           with the lattice. Every time step the fluid velocity is interpolated to the markers with
+ *           a regularised delta function of compact support (three cells in every direction), the
+ *           force that is required to enforce the velocity of the marker is evaluated and spread
+ *           back to the surrounding cells where it is added as a body force by the collision
+ *           kernels (Guo forcing). With the velocity of the kernels u = (sum f_i c_i + F/2)/rho the
+ *           marker force F = 2 rho (U_marker - u*) is the explicit direct forcing estimate: it only
+ *           removes the full slip of an isolated marker. The spread forces of neighbouring markers
+ *           overlap and the interpolation of the Roma delta function smooths them, so a residual
+ *           slip remains after a single forcing pass (no multi-direct forcing iterations are done).
+ *           Moving a body only requires updating the marker positions and costs O(markers).
+*/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../../continuum/continuum.hpp"
+#include "../../general/memory_alignment.hpp"
+#include "../population.hpp"
+
+
+/**\class  ImmersedBoundary
+ * \brief  Lagrangian markers of immersed bodies and the resulting Eulerian force density
+ *
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+ * \tparam LT   static lattice::DdQq class containing discretisation parameters
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT>
+class ImmersedBoundary
+{
+    public:
+        /// import current lattice floating data type
+        typedef typename std::remove_const<decltype(LT::CS)>::type T;
+
+        static constexpr unsigned int SUPPORT_ = 3;                                             ///< support of the delta function in cells
+        static constexpr size_t      MEM_SIZE_ = sizeof(T)*NZ*NY*NX*static_cast<size_t>(3);   ///< size of the force density in byte
+
+        /// Eulerian force density [Fx,Fy,Fz] per cell allocated in heap (handed to the collision kernels)
+        T* const F_ = static_cast<T*>(aligned_alloc(CACHE_LINE, MEM_SIZE_));
+
+        /// Lagrangian markers
+        std::vector<T> x_;      ///< position in x-direction
+        std::vector<T> y_;      ///< position in y-direction
+        std::vector<T> z_;      ///< position in z-direction
+        std::vector<T> u_;      ///< prescribed velocity in x-direction
+        std::vector<T> v_;      ///< prescribed velocity in y-direction
+        std::vector<T> w_;      ///< prescribed velocity in z-direction
+        std::vector<T> volume_; ///< volume associated with the marker (surface area times thickness)
+        std::vector<T> fx_;     ///< force density on the fluid in x-direction
+        std::vector<T> fy_;     ///< force density on the fluid in y-direction
+        std::vector<T> fz_;     ///< force density on the fluid in z-direction
+
+        /**\brief Class constructor: no markers and no force
+        */
+        ImmersedBoundary():
+            spread_(false)
+        {
+            if (F_ == nullptr)
+            {
+                std::cerr << "Fatal error: Immersed boundary could not be allocated." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+
+            T* const F = F_;
+            #pragma omp parallel for default(none) firstprivate(F) schedule(static)
+            for(size_t i = 0; i < static_cast<size_t>(NZ)*NY*NX*3; ++i)
+            {
+                F[i] = 0.0;
+            }
+        }
+
+        ImmersedBoundary(ImmersedBoundary const&) = delete;
+        ImmersedBoundary& operator= (ImmersedBoundary const&) = delete;
+
+        /**\brief Class destructor
+        */
+        ~ImmersedBoundary()
+        {
+            free(F_);
+        }
+
+        /**\fn        AddMarker
+         * \brief     Add a Lagrangian marker
+         *
+         * \param[in] x        position in x-direction
+         * \param[in] y        position in y-direction
+         * \param[in] z        position in z-direction
+         * \param[in] u        velocity in x-direction
+         * \param[in] v        velocity in y-direction
+         * \param[in] w        velocity in z-direction
+         * \param[in] volume   volume associated with the marker (default = 1)
+         * \return    Index of the marker
+        */
+        size_t AddMarker(T const x, T const y, T const z, T const u, T const v, T const w, T const volume = 1.0)
+        {
+            x_.push_back(x);
+            y_.push_back(y);
+            z_.push_back(z);
+            u_.push_back(u);
+            v_.push_back(v);
+            w_.push_back(w);
+            volume_.push_back(volume);
+            fx_.push_back(0.0);
+            fy_.push_back(0.0);
+            fz_.push_back(0.0);
+            return x_.size() - 1;
+        }
+
+        /**\fn        AddCylinder
+         * \brief     Add the markers of the surface of a cylinder parallel to the z-axis spanning the
+         *            entire domain with a spacing of about one cell
+         *
+         * \param[in] radius   radius of the cylinder
+         * \param[in] x        position of the axis in x-direction
+         * \param[in] y        position of the axis in y-direction
+         * \param[in] u        velocity in x-direction (default = 0)
+         * \param[in] v        velocity in y-direction (default = 0)
+        */
+        void AddCylinder(T const radius, T const x, T const y, T const u = 0.0, T const v = 0.0)
+        {
+            unsigned int const markers = std::max(static_cast<unsigned int>(std::ceil(2.0*M_PI*radius)), 3u);
+            T const arc = 2.0*M_PI*radius/markers;
+
+            for(unsigned int z = 0; z < NZ; ++z)
+            {
+                for(unsigned int m = 0; m < markers; ++m)
+                {
+                    T const phi = 2.0*M_PI*m/markers;
+                    AddMarker(x + radius*std::cos(phi), y + radius*std::sin(phi), z, u, v, 0.0, arc);
+                }
+            }
+        }
+
+        /**\fn        Translate
+         * \brief     Rigid body motion: displace all markers and set their velocity
+         *
+         * \param[in] dx   displacement in x-direction
+         * \param[in] dy   displacement in y-direction
+         * \param[in] dz   displacement in z-direction
+         * \param[in] u    new velocity in x-direction
+         * \param[in] v    new velocity in y-direction
+         * \param[in] w    new velocity in z-direction
+        */
+        void Translate(T const dx, T const dy, T const dz, T const u, T const v, T const w)
+        {
+            #pragma omp parallel for default(none) firstprivate(dx,dy,dz,u,v,w) schedule(static)
+            for(size_t m = 0; m < x_.size(); ++m)
+            {
+                x_[m] += dx;
+                y_[m] += dy;
+                z_[m] += dz;
+                u_[m]  = u;
+                v_[m]  = v;
+                w_[m]  = w;
+            }
+        }
+
+        /**\fn        Update
+         * \brief     Interpolate the velocity to all markers, evaluate the marker forces and spread
+         *            them to the force density of the following time step. Only the cells in the
+         *            support of the markers are touched.
+         *
+         * \tparam    odd   parity of the following time step: even (0, false) or odd (1, true)
+         * \param[in] pop   population object holding microscopic variables
+         * \param[in] p     relevant population (default = 0)
+        */
+        template <bool odd>
+        void Update(Population<NX,NY,NZ,LT> const& pop, unsigned int const p = 0)
+        {
+            size_t const markers = x_.size();
+            T* const F = F_;
+
+            /// reset the force density of the previous positions
+            if (spread_ == true)
+            {
+                #pragma omp parallel for default(none) firstprivate(markers,F) schedule(static)
+                for(size_t m = 0; m < markers; ++m)
+                {
+                    Support([F](size_t const cell, T const)
+                    {
+                        #pragma omp atomic write
+                        F[3*cell + 0] = 0.0;
+                        #pragma omp atomic write
+                        F[3*cell + 1] = 0.0;
+                        #pragma omp atomic write
+                        F[3*cell + 2] = 0.0;
+                    }, previous_[0][m], previous_[1][m], previous_[2][m]);
+                }
+            }
+
+            /// interpolate velocity and evaluate marker force
+            #pragma omp parallel for default(none) shared(pop) firstprivate(markers,p) schedule(static)
+            for(size_t m = 0; m < markers; ++m)
+            {
+                T rho = 0.0;
+                T u   = 0.0;
+                T v   = 0.0;
+                T w   = 0.0;
+
+                Support([&](size_t const cell, T const delta)
+                {
+                    unsigned int const x = cell % NX;
+                    unsigned int const y = (cell / NX) % NY;
+                    unsigned int const z = cell / (static_cast<size_t>(NX)*NY);
+                    unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
+                    unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };
+                    unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
+
+                    T r = 0.0;
+                    T j_x = 0.0;
+                    T j_y = 0.0;
+                    T j_z = 0.0;
+                    for(unsigned int n = 0; n <= 1; ++n)
+                    {
+                        for(unsigned int d = n; d < LT::HSPEED; ++d)
+                        {
+                            unsigned int const curr = n*LT::OFF + d;
+                            T const f = pop.F_[pop. template AA_IndexRead<odd>(x_n,y_n,z_n,n,d,p)];
+                            r   += f;
+                            j_x += f*LT::DX[curr];
+                            j_y += f*LT::DY[curr];
+                            j_z += f*LT::DZ[curr];
+                        }
+                    }
+
+                    rho += delta*r;
+                    u   += delta*j_x/r;
+                    v   += delta*j_y/r;
+                    w   += delta*j_z/r;
+                }, x_[m], y_[m], z_[m]);
+
+                fx_[m] = 2.0*rho*(u_[m] - u);
+                fy_[m] = 2.0*rho*(v_[m] - v);
+                fz_[m] = 2.0*rho*(w_[m] - w);
+            }
+
+            /// spread marker forces to the lattice
+            #pragma omp parallel for default(none) firstprivate(markers,F) schedule(static)
+            for(size_t m = 0; m < markers; ++m)
+            {
+                T const fx = fx_[m]*volume_[m];
+                T const fy = fy_[m]*volume_[m];
+                T const fz = fz_[m]*volume_[m];
+
+                Support([F,fx,fy,fz](size_t const cell, T const delta)
+                {
+                    #pragma omp atomic
+                    F[3*cell + 0] += delta*fx;
+                    #pragma omp atomic
+                    F[3*cell + 1] += delta*fy;
+                    #pragma omp atomic
+                    F[3*cell + 2] += delta*fz;
+                }, x_[m], y_[m], z_[m]);
+            }
+
+            previous_[0] = x_;
+            previous_[1] = y_;
+            previous_[2] = z_;
+            spread_ = true;
+        }
+
+        /**\fn        GetForce
+         * \brief     Total force of the fluid on all markers (e.g. drag and lift)
+         *
+         * \return    Force [Fx,Fy,Fz] acting on the immersed bodies
+        */
+        std::array<T,3> GetForce() const
+        {
+            T fx = 0.0;
+            T fy = 0.0;
+            T fz = 0.0;
+
+            for(size_t m = 0; m < x_.size(); ++m)
+            {
+                fx -= fx_[m]*volume_[m];
+                fy -= fy_[m]*volume_[m];
+                fz -= fz_[m]*volume_[m];
+            }
+
+            return { fx, fy, fz };
+        }
+
+        /**\fn        GetSlip
+         * \brief     Largest deviation of the fluid velocity interpolated to the markers from the velocity
+         *            of the markers (residual of the no-slip condition)
+         *
+         * \param[in] con   continuum object holding the velocities including the half-force shift
+         *                  (e.g. ComputeMacroscopic with the force density F_)
+         * \return    Magnitude of the largest slip velocity
+        */
+        T GetSlip(Continuum<NX,NY,NZ,T> const& con) const
+        {
+            T slip = 0.0;
+
+            for(size_t m = 0; m < x_.size(); ++m)
+            {
+                T u = 0.0;
+                T v = 0.0;
+                T w = 0.0;
+
+                Support([&](size_t const cell, T const delta)
+                {
+                    unsigned int const x = cell % NX;
+                    unsigned int const y = (cell / NX) % NY;
+                    unsigned int const z = cell / (static_cast<size_t>(NX)*NY);
+                    u += delta*con(x, y, z, 1);
+                    v += delta*con(x, y, z, 2);
+                    w += delta*con(x, y, z, 3);
+                }, x_[m], y_[m], z_[m]);
+
+                slip = std::max(slip, std::sqrt((u - u_[m])*(u - u_[m]) + (v - v_[m])*(v - v_[m]) + (w - w_[m])*(w - w_[m])));
+            }
+
+            return slip;
+        }
+
+    private:
+        std::vector<T> previous_[3];    ///< marker positions of the last spreading
+        bool           spread_;         ///< force density holds spread forces
+
+        /**\fn        Delta
+         * \brief     Regularised delta function with a support of three cells (Roma et al.)
+         *
+         * \param[in] r   distance in lattice units
+         * \return    Weight of the distance in one dimension
+        */
+        static T Delta(T const r)
+        {
+            T const a = std::abs(r);
+
+            if (a <= 0.5)
+            {
+                return (1.0 + std::sqrt(1.0 - 3.0*a*a))/3.0;
+            }
+            else if (a <= 1.5)
+            {
+                return (5.0 - 3.0*a - std::sqrt(std::max(1.0 - 3.0*(1.0 - a)*(1.0 - a), 0.0)))/6.0;
+            }
+            return 0.0;
+        }
+
+        /**\fn        Support
+         * \brief     Call a function for all cells in the support of a marker with the corresponding
+         *            weight of the delta function (periodic)
+         *
+         * \param[in] function   callable with the signature (size_t cell, T delta)
+         * \param[in] px         position of the marker in x-direction
+         * \param[in] py         position of the marker in y-direction
+         * \param[in] pz         position of the marker in z-direction
+        */
+        template <typename Function>
+        static inline void Support(Function const& function, T const px, T const py, T const pz)
+        {
+            int const x_0 = static_cast<int>(std::floor(px + 0.5)) - 1;
+            int const y_0 = static_cast<int>(std::floor(py + 0.5)) - 1;
+            int const z_0 = static_cast<int>(std::floor(pz + 0.5)) - 1;
+
+            for(int k = z_0; k < z_0 + static_cast<int>(SUPPORT_); ++k)
+            {
+                T const d_z = Delta(k - pz);
+                unsigned int const z = (k % static_cast<int>(NZ) + NZ) % NZ;
+
+                for(int j = y_0; j < y_0 + static_cast<int>(SUPPORT_); ++j)
+                {
+                    T const d_y = Delta(j - py);
+                    unsigned int const y = (j % static_cast<int>(NY) + NY) % NY;
+
+                    for(int i = x_0; i < x_0 + static_cast<int>(SUPPORT_); ++i)
+                    {
+                        unsigned int const x = (i % static_cast<int>(NX) + NX) % NX;
+                        function((static_cast<size_t>(z)*NY + y)*NX + x, Delta(i - px)*d_y*d_z);
+                    }
+                }
+            }
+        }
+};
+
+#endif // BOUNDARY_IMMERSED_HPP_INCLUDED
@@ -0,0 +1,112 @@
+#ifndef BOUNDARY_IMMERSED_UNIT_TEST_HPP_INCLUDED
+#define BOUNDARY_IMMERSED_UNIT_TEST_HPP_INCLUDED
+
+/**
+ * \file     boundary_immersed_unit_test.hpp
+ * \mainpage Regression test for the immersed boundary: drag, momentum balance and no-slip residual
+*/
+
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+
+#include "../../continuum/continuum.hpp"
+#include "../../continuum/initialisation.hpp"
+#include "../../lattice/D3Q19.hpp"
+#include "../collision/collision_bgk.hpp"
+#include "../initialisation.hpp"
+#include "../macroscopic.hpp"
+#include "../population.hpp"
+#include "boundary_immersed.hpp"
+
+
+/**\fn     UnitTestImmersedBoundary
+ * \brief  Impulsively started flow around a cylinder of Lagrangian markers in a periodic channel
+ *         (Re = 20 with respect to the diameter). The momentum lost by the fluid has to equal the
+ *         impulse of the marker forces to round-off, the drag averaged over the second half of the
+ *         run has to match the regression value and the slip velocity at the markers has to be small.
+ *
+ * \return EXIT_SUCCESS if the test passed, else EXIT_FAILURE
+*/
+inline int UnitTestImmersedBoundary()
+{
+    constexpr unsigned int NX = 64;
+    constexpr unsigned int NY = 40;
+    constexpr unsigned int NZ = 1;
+    constexpr unsigned int NT = 2000;
+    typedef lattice::D3Q19<double> DdQq;
+
+    constexpr double  U = 0.05;
+    constexpr double  D = 10.0;
+    constexpr double Re = 20.0;
+
+    /// regression value of the drag coefficient with respect to the initial velocity averaged over the
+    /// second half, recorded from a run of this solver (not a published value: it only detects changes)
+    constexpr double DRAG_REGRESSION = 1.4282;
+
+    Continuum<NX,NY,NZ,double> Macro;
+    Population<NX,NY,NZ,DdQq>  Micro(Re, U, D);
+    InitContinuum(Macro, 1.0, U, 0.0, 0.0);
+    InitLattice<false>(Macro, Micro);
+
+    ImmersedBoundary<NX,NY,NZ,DdQq> Body;
+    Body.AddCylinder(0.5*D, NX/4, NY/2);
+
+    auto const Momentum = [&]() -> double
+    {
+        double momentum = 0.0;
+        for(unsigned int y = 0; y < NY; ++y)
+        {
+            for(unsigned int x = 0; x < NX; ++x)
+            {
+                momentum += Macro(x,y,0,0)*Macro(x,y,0,1);
+            }
+        }
+        return momentum;
+    };
+    double const initial = Momentum();
+
+    double impulse = 0.0;
+    double    drag = 0.0;
+    for(unsigned int i = 0; i < NT; i += 2)
+    {
+        Body.Update<false>(Micro);
+        impulse += Body.GetForce()[0];
+        drag    += (i >= NT/2) ? Body.GetForce()[0] : 0.0;
+        CollideStreamBGK<false>(Macro, Micro, 0, 0, Micro.NUM_BLOCKS_, nullptr, Body.F_);
+
+        Body.Update<true>(Micro);
+        impulse += Body.GetForce()[0];
+        drag    += (i >= NT/2) ? Body.GetForce()[0] : 0.0;
+        CollideStreamBGK<true>(Macro, Micro, 0, 0, Micro.NUM_BLOCKS_, nullptr, Body.F_);
+    }
+    double const coefficient = drag/(NT/2)/(0.5*U*U*D*NZ);
+
+    ComputeMacroscopic<false>(Macro, Micro, 0);
+    double const balance = std::abs((initial - Momentum()) - impulse)/impulse;
+
+    Body.Update<false>(Micro);
+    ComputeMacroscopic<false>(Macro, Micro, 0, Body.F_);
+    double const slip = Body.GetSlip(Macro)/U;
+
+    int result = EXIT_SUCCESS;
+    if (balance > 1e-9)
+    {
+        std::cerr << "Error: Momentum of the fluid does not balance the marker forces (" << balance << ")." << std::endl;
+        result = EXIT_FAILURE;
+    }
+    if (std::abs(coefficient - DRAG_REGRESSION) > 0.01*DRAG_REGRESSION)
+    {
+        std::cerr << "Error: Drag coefficient " << coefficient << " differs from regression value " << DRAG_REGRESSION << "." << std::endl;
+        result = EXIT_FAILURE;
+    }
+    if (slip > 0.02)
+    {
+        std::cerr << "Error: Slip velocity at the markers of " << slip << " times the free stream." << std::endl;
+        result = EXIT_FAILURE;
+    }
+
+    return result;
+}
+
+#endif // BOUNDARY_IMMERSED_UNIT_TEST_HPP_INCLUDED
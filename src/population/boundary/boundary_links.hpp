@@ -0,0 +1,162 @@
+#ifndef BOUNDARY_LINKS_HPP_INCLUDED
+#define BOUNDARY_LINKS_HPP_INCLUDED
+
+/**
+ * \file     boundary_links.hpp
+ * \mainpage Link-wise representation of solid walls
+ *
+ * \note     Halfway bounce-back only has to reflect populations along links between a fluid cell
+ *           x_f and a solid cell x_s = x_f + c_i. With the A-A access pattern both populations of
+ *           such a link are found in fixed slots: the population f_i leaving the fluid cell is held
+ *           by slot i of the fluid cell after even steps and has to be reflected into slot -i of the
+ *           solid cell (read by the fluid cell in the following odd step as f_-i), while after odd
+ *           steps the population streamed into slot -i of the solid cell has to be copied back to
+ *           slot i of the fluid cell. A list of only these links is therefore sufficient, all links
+ *           between solid cells are dropped.
+*/
+
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "boundary_list.hpp"
+#include "../population.hpp"
+
+
+/**\class  LinkList
+ * \brief  Structure of arrays holding all links between fluid and solid cells with the linear
+ *         indices of both populations involved
+ *
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+ * \tparam LT   static lattice::DdQq class containing discretisation parameters
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT>
+class LinkList
+{
+    public:
+        /// import current lattice floating data type
+        typedef typename std::remove_const<decltype(LT::CS)>::type T;
+
+        size_t const SIZE_;                 ///< number of links
+
+        std::vector<size_t>       fluid_;   ///< population i = n*OFF + d of the fluid cell x_f
+        std::vector<size_t>       solid_;   ///< population -i = !n*OFF + d of the solid cell x_s = x_f + c_i
+        std::vector<unsigned int> link_;    ///< lattice velocity i = n*OFF + d of the link
+        std::vector<unsigned int> body_;    ///< tag of the solid body the link belongs to
+
+        /**\brief     Class constructor: determines all links between fluid and solid cells in parallel
+         * \warning   The solid cells have to be flagged in the population beforehand (pop.flags_).
+         *
+         * \param[in] wall   compact list holding (at least) all solid nodes adjacent to fluid cells
+         * \param[in] pop    population object holding the cell types
+        */
+        LinkList(BoundaryList<NX,NY,NZ,LT> const& wall, Population<NX,NY,NZ,LT> const& pop):
+            LinkList(wall, pop.flags_)
+        {
+        }
+
+        /**\brief     Class constructor: determines all links from cell types that are not (yet) held by
+         *            a population, e.g. a geometry shared by several simulations
+         *
+         * \tparam    BLOCK_SIZE   loop block size of the cell types
+         * \param[in] wall         compact list holding (at least) all solid nodes adjacent to fluid cells
+         * \param[in] flags        cell types of the domain
+        */
+        template <unsigned int BLOCK_SIZE>
+        LinkList(BoundaryList<NX,NY,NZ,LT> const& wall, CellFlags<NX,NY,NZ,BLOCK_SIZE> const& flags):
+            LinkList(wall, flags, Count(wall, flags))
+        {
+        }
+
+    private:
+        /**\brief     Class constructor: fills the links of all nodes in parallel
+         *
+         * \param[in] wall     compact list holding (at least) all solid nodes adjacent to fluid cells
+         * \param[in] flags    cell types of the domain
+         * \param[in] offset   index of the first link of every node (exclusive prefix sum)
+        */
+        template <unsigned int BLOCK_SIZE>
+        LinkList(BoundaryList<NX,NY,NZ,LT> const& wall, CellFlags<NX,NY,NZ,BLOCK_SIZE> const& flags, std::vector<size_t> const& offset):
+            SIZE_(offset.back()), fluid_(SIZE_), solid_(SIZE_), link_(SIZE_), body_(SIZE_)
+        {
+            #pragma omp parallel for default(none) shared(wall,flags,offset) schedule(static,32)
+            for(size_t i = 0; i < wall.SIZE_; ++i)
+            {
+                size_t l = offset[i];
+
+                for(unsigned int n = 0; n <= 1; ++n)
+                {
+                    for(unsigned int d = 1; d < LT::HSPEED; ++d)
+                    {
+                        unsigned int const curr = n*LT::OFF + d;
+
+                        if (IsFluid(wall, flags, i, curr) == true)
+                        {
+                            // fluid cell x_f = x_s - c_i is the neighbour of the solid cell in direction -i
+                            fluid_[l] = wall.neighbour_[i*LT::ND + (!n)*LT::OFF + d] + curr;
+                            solid_[l] = wall.neighbour_[i*LT::ND] + (!n)*LT::OFF + d;
+                            link_[l]  = curr;
+                            body_[l]  = wall.body_[i];
+                            ++l;
+                        }
+                    }
+                }
+            }
+        }
+
+        /**\fn        IsFluid
+         * \brief     Determine if the neighbour x_s - c_i of a solid node is not solid
+        */
+        template <unsigned int BLOCK_SIZE>
+        static bool IsFluid(BoundaryList<NX,NY,NZ,LT> const& wall, CellFlags<NX,NY,NZ,BLOCK_SIZE> const& flags,
+                            size_t const i, unsigned int const curr)
+        {
+            unsigned int x = 0;
+            unsigned int y = 0;
+            unsigned int z = 0;
+            wall.GetPosition(i, x, y, z);
+
+            return !flags.Is((NX + x - static_cast<int>(LT::DX[curr])) % NX,
+                             (NY + y - static_cast<int>(LT::DY[curr])) % NY,
+                             (NZ + z - static_cast<int>(LT::DZ[curr])) % NZ, SOLID);
+        }
+
+        /**\fn        Count
+         * \brief     Count the links of every solid node in parallel
+         *
+         * \param[in] wall   compact list holding (at least) all solid nodes adjacent to fluid cells
+         * \param[in] flags  cell types of the domain
+         * \return    Index of the first link of every node and total number of links as last element
+        */
+        template <unsigned int BLOCK_SIZE>
+        static std::vector<size_t> Count(BoundaryList<NX,NY,NZ,LT> const& wall, CellFlags<NX,NY,NZ,BLOCK_SIZE> const& flags)
+        {
+            std::vector<size_t> offset(wall.SIZE_ + 1, 0);
+
+            #pragma omp parallel for default(none) shared(wall,flags,offset) schedule(static,32)
+            for(size_t i = 0; i < wall.SIZE_; ++i)
+            {
+                for(unsigned int n = 0; n <= 1; ++n)
+                {
+                    for(unsigned int d = 1; d < LT::HSPEED; ++d)
+                    {
+                        offset[i + 1] += IsFluid(wall, flags, i, n*LT::OFF + d);
+                    }
+                }
+            }
+
+            for(size_t i = 0; i < wall.SIZE_; ++i)
+            {
+                offset[i + 1] += offset[i];
+            }
+
+            return offset;
+        }
+};
+
+#endif // BOUNDARY_LINKS_HPP_INCLUDED
@@ -0,0 +1,294 @@
+#ifndef BOUNDARY_LIST_HPP_INCLUDED
+#define BOUNDARY_LIST_HPP_INCLUDED
+
+/**
+ * \file     boundary_list.hpp
+ * \mainpage Compact representation of boundary nodes with precomputed population indices
+ *
+ * \note     The boundary treatments are performed every time step for the same nodes. Instead of
+ *           recomputing the periodic neighbours and the A-A indices of every node from its
+ *           coordinates, the nodes are converted once into a structure of arrays: sorted by memory
+ *           address and free of duplicates, holding the first population of every cell that is
+ *           accessed. As even steps only access the cell itself and odd steps only its neighbours,
+ *           the linear index of a population for both parities follows from these cells by a
+ *           compile-time choice of slot, and the boundary treatments reduce to a streaming loop
+ *           over index arrays. Boundary values that are uniform for all nodes are stored only once.
+*/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <stdlib.h>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "boundary.hpp"
+#include "boundary_orientation.hpp"
+
+
+/**\class  BoundaryList
+ * \brief  Boundary nodes as structure of arrays with precomputed population indices
+ *
+ * \tparam NX            simulation domain resolution in x-direction
+ * \tparam NY            simulation domain resolution in y-direction
+ * \tparam NZ            simulation domain resolution in z-direction
+ * \tparam LT            static lattice::DdQq class containing discretisation parameters
+ * \tparam Orientation   normal pointing to the cell the boundary values are interpolated from
+ *                       (default = orientation::None: the node itself, e.g. solid walls)
+ * \tparam NPOP          number of populations stored side by side in the lattice (default = 1)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class Orientation = orientation::None, unsigned int NPOP = 1>
+class BoundaryList
+{
+    public:
+        /// import current lattice floating data type
+        typedef typename std::remove_const<decltype(LT::CS)>::type T;
+
+        /// boundary values are interpolated from a neighbouring cell
+        static constexpr bool SHIFT_ = (Orientation::x != 0) || (Orientation::y != 0) || (Orientation::z != 0);
+
+        size_t const SIZE_;                 ///< number of boundary nodes
+
+        std::vector<size_t> cell_;          ///< linear cell index (z*NY + y)*NX + x of every node in ascending order
+        std::vector<size_t> neighbour_;     ///< per node: first population of the cell x + c_i for every lattice velocity i = n*OFF + d
+        std::vector<size_t> source_;        ///< per node: same for the cell x + normal the values are interpolated from (empty without orientation)
+        std::vector<unsigned int> body_;    ///< tag of the solid body every node belongs to
+
+        bool uniform_;                      ///< identical boundary values for all nodes: stored only once
+        std::vector<T> rho_;                ///< boundary density
+        std::vector<T> u_;                  ///< boundary velocity in x-direction
+        std::vector<T> v_;                  ///< boundary velocity in y-direction
+        std::vector<T> w_;                  ///< boundary velocity in z-direction
+
+        /**\brief     Class constructor: sorts the boundary elements by memory address, removes
+         *            duplicates and precomputes the population indices of all nodes in parallel
+         *
+         * \param[in] boundary   vector holding all corresponding boundary condition elements
+        */
+        BoundaryList(std::vector<boundaryElement<T>> const& boundary):
+            BoundaryList(boundary, Unique(boundary))
+        {
+        }
+
+        /**\fn        GetPosition
+         * \brief     Spatial position of a boundary node
+         *
+         * \param[in]  i   index of the boundary node
+         * \param[out] x   x coordinate of cell
+         * \param[out] y   y coordinate of cell
+         * \param[out] z   z coordinate of cell
+        */
+        void GetPosition(size_t const i, unsigned int& x, unsigned int& y, unsigned int& z) const
+        {
+            x = cell_[i] % NX;
+            y = (cell_[i] / NX) % NY;
+            z = cell_[i] / (static_cast<size_t>(NX)*NY);
+        }
+
+        /**\fn        GetValues
+         * \brief     Macroscopic boundary values of a node
+         * \warning   Inline function! Called from within the boundary treatments.
+         *
+         * \param[in] i   index of the boundary node
+         * \return    Boundary values [rho,u,v,w]
+        */
+        inline std::array<double,4> __attribute__((always_inline)) GetValues(size_t const i) const
+        {
+            size_t const j = uniform_ ? 0 : i;
+            return { rho_[j], u_[j], v_[j], w_[j] };
+        }
+
+        /**\fn        IndexRead
+         * \brief     Linear index of a population of the node before collision (see AA_IndexRead)
+         * \warning   Inline function! Called from within the boundary treatments.
+         *
+         * \tparam    odd   even (0, false) or odd (1, true) time step
+         * \param[in] i     index of the boundary node
+         * \param[in] n     positive (0) or negative (1) index/lattice velocity
+         * \param[in] d     relevant population index
+         * \param[in] p     relevant population (default = 0)
+         * \return    requested linear population index before collision
+        */
+        template <bool odd>
+        inline size_t __attribute__((always_inline)) IndexRead(size_t const i, unsigned int const n, unsigned int const d, unsigned int const p = 0) const
+        {
+            return Read<odd>(neighbour_.data(), i, n, d, p);
+        }
+
+        /**\fn        IndexWrite
+         * \brief     Linear index of a population of the node after collision (see AA_IndexWrite)
+         * \warning   Inline function! Called from within the boundary treatments.
+         *
+         * \tparam    odd   even (0, false) or odd (1, true) time step
+         * \param[in] i     index of the boundary node
+         * \param[in] n     positive (0) or negative (1) index/lattice velocity
+         * \param[in] d     relevant population index
+         * \param[in] p     relevant population (default = 0)
+         * \return    requested linear population index after collision
+        */
+        template <bool odd>
+        inline size_t __attribute__((always_inline)) IndexWrite(size_t const i, unsigned int const n, unsigned int const d, unsigned int const p = 0) const
+        {
+            size_t const* const cell = neighbour_.data() + i*LT::ND;
+            return (odd ? cell[n*LT::OFF + d] : cell[0]) + ((odd ? !n : n)*LT::OFF + d)*NPOP + p;
+        }
+
+        /**\fn        SourceRead
+         * \brief     Linear index of a population before collision of the cell the boundary values
+         *            of the node are interpolated from
+         * \warning   Inline function! Called from within the boundary treatments.
+         *
+         * \tparam    odd   even (0, false) or odd (1, true) time step
+         * \param[in] i     index of the boundary node
+         * \param[in] n     positive (0) or negative (1) index/lattice velocity
+         * \param[in] d     relevant population index
+         * \param[in] p     relevant population (default = 0)
+         * \return    requested linear population index before collision
+        */
+        template <bool odd>
+        inline size_t __attribute__((always_inline)) SourceRead(size_t const i, unsigned int const n, unsigned int const d, unsigned int const p = 0) const
+        {
+            if constexpr (SHIFT_ == true)
+            {
+                return Read<odd>(source_.data(), i, n, d, p);
+            }
+            else
+            {
+                return Read<odd>(neighbour_.data(), i, n, d, p);
+            }
+        }
+
+    private:
+        /**\brief     Class constructor: precomputes the population indices of all nodes in parallel
+         *
+         * \param[in] boundary   vector holding all corresponding boundary condition elements
+         * \param[in] order      indices of the elements in ascending order of their cells without duplicates
+        */
+        BoundaryList(std::vector<boundaryElement<T>> const& boundary, std::vector<size_t> const& order):
+            SIZE_(order.size()), uniform_(true)
+        {
+            // values are shared if they agree within the floating point accuracy
+            auto const Differ = [](T const l, T const r) -> bool
+            {
+                return std::abs(l - r) > std::numeric_limits<T>::epsilon()*std::max(std::abs(l), std::abs(r));
+            };
+
+            for(size_t i = 1; i < SIZE_; ++i)
+            {
+                boundaryElement<T> const& a = boundary[order[0]];
+                boundaryElement<T> const& b = boundary[order[i]];
+                if (Differ(a.rho, b.rho) || Differ(a.u, b.u) || Differ(a.v, b.v) || Differ(a.w, b.w))
+                {
+                    uniform_ = false;
+                    break;
+                }
+            }
+
+            size_t const VALUES = uniform_ ? std::min(SIZE_, static_cast<size_t>(1)) : SIZE_;
+            cell_.resize(SIZE_);
+            neighbour_.resize(SIZE_*LT::ND);
+            source_.resize(SHIFT_ ? SIZE_*LT::ND : 0);
+            body_.resize(SIZE_);
+            rho_.resize(VALUES);
+            u_.resize(VALUES);
+            v_.resize(VALUES);
+            w_.resize(VALUES);
+
+            #pragma omp parallel for default(none) shared(boundary,order) firstprivate(VALUES) schedule(static)
+            for(size_t i = 0; i < SIZE_; ++i)
+            {
+                boundaryElement<T> const& e = boundary[order[i]];
+
+                cell_[i] = LinearCell(e.x, e.y, e.z);
+                body_[i] = e.body;
+                if (i < VALUES)
+                {
+                    rho_[i] = e.rho;
+                    u_[i]   = e.u;
+                    v_[i]   = e.v;
+                    w_[i]   = e.w;
+                }
+
+                Neighbours(e.x, e.y, e.z, &neighbour_[i*LT::ND]);
+                if constexpr (SHIFT_ == true)
+                {
+                    Neighbours(e.x + Orientation::x, e.y + Orientation::y, e.z + Orientation::z, &source_[i*LT::ND]);
+                }
+            }
+        }
+
+        /**\fn        LinearCell
+         * \brief     Linear index of a cell
+        */
+        static size_t LinearCell(unsigned int const x, unsigned int const y, unsigned int const z)
+        {
+            return (static_cast<size_t>(z)*NY + y)*NX + x;
+        }
+
+        /**\fn        Unique
+         * \brief     Order of the boundary elements sorted by memory address without duplicates
+         *
+         * \param[in] boundary   vector holding all corresponding boundary condition elements
+         * \return    Indices of the elements in ascending order of their cells
+        */
+        static std::vector<size_t> Unique(std::vector<boundaryElement<T>> const& boundary)
+        {
+            std::vector<size_t> order(boundary.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&boundary](size_t const a, size_t const b)
+                             { return LinearCell(boundary[a].x, boundary[a].y, boundary[a].z) <
+                                      LinearCell(boundary[b].x, boundary[b].y, boundary[b].z); });
+            order.erase(std::unique(order.begin(), order.end(), [&boundary](size_t const a, size_t const b)
+                        { return LinearCell(boundary[a].x, boundary[a].y, boundary[a].z) ==
+                                 LinearCell(boundary[b].x, boundary[b].y, boundary[b].z); }), order.end());
+            return order;
+        }
+
+        /**\fn        Neighbours
+         * \brief     First population of the cell x + c_i for every lattice velocity i = n*OFF + d
+         *            with periodic wrap-around
+         *
+         * \param[in]  x           x coordinate of cell
+         * \param[in]  y           y coordinate of cell
+         * \param[in]  z           z coordinate of cell
+         * \param[out] neighbour   ND linear population indices
+        */
+        static void Neighbours(unsigned int const x, unsigned int const y, unsigned int const z, size_t* const neighbour)
+        {
+            for(unsigned int i = 0; i < LT::ND; ++i)
+            {
+                neighbour[i] = LinearCell(x, y, z)*NPOP*LT::ND;
+            }
+
+            for(unsigned int n = 0; n <= 1; ++n)
+            {
+                for(unsigned int d = n; d < LT::HSPEED; ++d)
+                {
+                    unsigned int const curr = n*LT::OFF + d;
+                    unsigned int const x_n = (NX + x + static_cast<int>(LT::DX[curr])) % NX;
+                    unsigned int const y_n = (NY + y + static_cast<int>(LT::DY[curr])) % NY;
+                    unsigned int const z_n = (NZ + z + static_cast<int>(LT::DZ[curr])) % NZ;
+                    neighbour[curr] = LinearCell(x_n, y_n, z_n)*NPOP*LT::ND;
+                }
+            }
+        }
+
+        /**\fn        Read
+         * \brief     Linear index of a population before collision: even time steps read the cell
+         *            itself, odd ones the neighbour opposite to the lattice velocity
+        */
+        template <bool odd>
+        static inline size_t __attribute__((always_inline)) Read(size_t const* const neighbour, size_t const i,
+                                                                 unsigned int const n, unsigned int const d, unsigned int const p)
+        {
+            size_t const* const cell = neighbour + i*LT::ND;
+            return (odd ? cell[!n*LT::OFF + d] : cell[0]) + ((odd ? n : !n)*LT::OFF + d)*NPOP + p;
+        }
+};
+
+#endif // BOUNDARY_LIST_HPP_INCLUDED
@@ -0,0 +1,169 @@
+#ifndef BOUNDARY_MOMENTUM_HPP_INCLUDED
+#define BOUNDARY_MOMENTUM_HPP_INCLUDED
+
+/**
+ * \file     boundary_momentum.hpp
+ * \mainpage Forces on solid bodies by momentum exchange
+ * \note     "Force evaluation in the lattice Boltzmann method involving curved geometry"
+ *           R. Mei, D. Yu, W. Shyy, L.S. Luo
+ *           Physical Review E 65 (2002)
+ *           DOI: 10.1103/PhysRevE.65.041203
+*/
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+#include "boundary.hpp"
+#include "boundary_list.hpp"
+#include "../../general/paths.hpp"
+#include "../population.hpp"
+
+
+/**\class  MomentumExchange
+ * \brief  Links between fluid and solid cells and the resulting force on every tagged solid body.
+ *         The forces are evaluated by the bounce-back boundary itself (see BounceBackHalfway).
+ * \note   With halfway bounce-back every population f_i that streamed from a fluid cell into a
+ *         solid cell is reflected with the same value, transferring the momentum 2 f_i c_i to the
+ *         body the solid cell belongs to.
+ *
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+ * \tparam LT   static lattice::DdQq class containing discretisation parameters
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT>
+class MomentumExchange
+{
+    public:
+        /// import current lattice floating data type
+        typedef typename std::remove_const<decltype(LT::CS)>::type T;
+
+        static_assert(LT::ND <= 64, "Link mask limited to 64 populations per cell.");
+
+        unsigned int const BODIES_;         ///< number of tagged bodies
+
+        std::vector<uint64_t> links_;       ///< per wall node: bit n*OFF+d set if population arrives from a fluid cell
+        std::vector<T>        force_;       ///< force on each body in the last time step [Fx,Fy,Fz] in lattice units
+
+        /**\brief     Class constructor: determines all links between fluid and solid cells
+         *
+         * \param[in] wall   compact list holding all solid nodes treated by bounce-back
+         * \param[in] pop    population object holding the cell types (solid cells not contained
+         *                   in the list)
+         * \param[in] name   name of the force output file (default = "forces")
+        */
+        MomentumExchange(BoundaryList<NX,NY,NZ,LT> const& wall, Population<NX,NY,NZ,LT> const& pop,
+                         std::string const& name = "forces"):
+            BODIES_(wall.body_.empty() ? 1 : 1 + *std::max_element(wall.body_.begin(), wall.body_.end())),
+            links_(wall.SIZE_, 0), force_(3*BODIES_, 0.0), file_(nullptr), name_(name)
+        {
+            /// solid cells
+            std::vector<bool> solid(static_cast<size_t>(NX)*NY*NZ, false);
+            for(size_t i = 0; i < wall.SIZE_; ++i)
+            {
+                solid[wall.cell_[i]] = true;
+            }
+
+            /// populations that arrive from fluid cells
+            for(size_t i = 0; i < wall.SIZE_; ++i)
+            {
+                unsigned int x_w = 0;
+                unsigned int y_w = 0;
+                unsigned int z_w = 0;
+                wall.GetPosition(i, x_w, y_w, z_w);
+
+                for(unsigned int n = 0; n <= 1; ++n)
+                {
+                    for(unsigned int d = 1; d < LT::HSPEED; ++d)
+                    {
+                        unsigned int const curr = n*LT::OFF + d;
+                        unsigned int const x = (NX + x_w - static_cast<int>(LT::DX[curr])) % NX;
+                        unsigned int const y = (NY + y_w - static_cast<int>(LT::DY[curr])) % NY;
+                        unsigned int const z = (NZ + z_w - static_cast<int>(LT::DZ[curr])) % NZ;
+
+                        if ((solid[(static_cast<size_t>(z)*NY + y)*NX + x] == false) && (pop.flags_.Is(x, y, z, SOLID) == false))
+                        {
+                            links_[i] |= static_cast<uint64_t>(1) << curr;
+                        }
+                    }
+                }
+            }
+        }
+
+        /**\brief     Class constructor for link-wise bounce-back: the links are held by the link list
+         *
+         * \tparam    Links  link list holding the tag of the body of every link (e.g. LinkList, BouzidiLinks)
+         * \param[in] links  list holding all links between fluid and solid cells
+         * \param[in] name   name of the force output file (default = "forces")
+        */
+        template <class Links>
+        MomentumExchange(Links const& links, std::string const& name = "forces"):
+            BODIES_(links.body_.empty() ? 1 : 1 + *std::max_element(links.body_.begin(), links.body_.end())),
+            links_(), force_(3*BODIES_, 0.0), file_(nullptr), name_(name)
+        {
+        }
+
+        MomentumExchange(MomentumExchange const&) = delete;
+        MomentumExchange& operator= (MomentumExchange const&) = delete;
+
+        ~MomentumExchange()
+        {
+            if (file_ != nullptr)
+            {
+                fclose(file_);
+            }
+        }
+
+        /**\fn        GetForce
+         * \brief     Force on a body in the last time step in lattice units
+         *
+         * \param[in] body   tag of the body
+         * \return    Force [Fx,Fy,Fz] acting on the body
+        */
+        std::array<T,3> GetForce(unsigned int const body) const
+        {
+            return { force_[3*body + 0], force_[3*body + 1], force_[3*body + 2] };
+        }
+
+        /**\fn        Export
+         * \brief     Append the forces on all bodies of the last time step to the (buffered) text
+         *            file OUTPUT_BIN_PATH/<name>.txt: step followed by Fx Fy Fz of every body
+         *
+         * \param[in] step   number of completed time steps
+        */
+        void Export(size_t const step)
+        {
+            if (file_ == nullptr)
+            {
+                struct stat info;
+                std::string const fileName = OUTPUT_BIN_PATH + std::string("/") + name_ + std::string(".txt");
+
+                if ((stat(OUTPUT_BIN_PATH.c_str(), &info) != 0) || !S_ISDIR(info.st_mode) ||
+                    ((file_ = fopen(fileName.c_str(), "w")) == nullptr))
+                {
+                    std::cerr << "Fatal error: Could not create '" << fileName << "'." << std::endl;
+                    exit(EXIT_FAILURE);
+                }
+                fprintf(file_, "# step Fx Fy Fz (per body, lattice units)\n");
+            }
+
+            fprintf(file_, "%zu", step);
+            for(size_t i = 0; i < force_.size(); ++i)
+            {
+                fprintf(file_, " %.9e", static_cast<double>(force_[i]));
+            }
+            fprintf(file_, "\n");
+        }
+
+    private:
+        FILE*             file_;            ///< force output file (opened with the first export)
+        std::string const name_;            ///< name of the force output file
+};
+
+#endif // BOUNDARY_MOMENTUM_HPP_INCLUDED
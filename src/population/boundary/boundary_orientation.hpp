@@ -8,6 +8,14 @@
 
 namespace orientation
 {
+    class None
+    {
+        public:
+            static constexpr int x =  0; ///< no normal direction (e.g. solid walls)
+            static constexpr int y =  0;
+            static constexpr int z =  0;
+    };
+
     class Left
     {
         public:
@@ -0,0 +1,129 @@
+#ifndef BOUNDARY_SPONGE_HPP_INCLUDED
+#define BOUNDARY_SPONGE_HPP_INCLUDED
+
+/**
+ * \file     boundary_sponge.hpp
+ * \mainpage Absorbing sponge layers in front of open boundaries
+ * \note     "Analysis of the absorbing layers for the weakly-compressible lattice Boltzmann methods"
+ *           H. Xu, P. Sagaut
+ *           Journal of Computational Physics 245 (2013)
+ *           DOI: 10.1016/j.jcp.2013.03.039
+ *
+ *           Inside a layer of given width the post-collision populations are relaxed towards the
+ *           equilibrium of the far-field state and the relaxation time is increased. Both are ramped
+ *           up smoothly from zero at the inner edge of the layer to their maximum at the boundary so
+ *           that the disturbances are damped before they reach the boundary without being reflected
+ *           by the layer itself. The sponge is evaluated by the collision kernels within the sweep.
+*/
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include "../../general/memory_alignment.hpp"
+
+
+/**\class  Sponge
+ * \brief  Ramp profiles of the absorbing layers and the far-field equilibrium
+ *
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+ * \tparam LT   static lattice::DdQq class containing discretisation parameters
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT>
+class Sponge
+{
+    public:
+        /// import current lattice floating data type
+        typedef typename std::remove_const<decltype(LT::CS)>::type T;
+
+        T const STRENGTH_;      ///< maximum relaxation rate towards the far-field equilibrium per time step
+        T const TAU_;           ///< maximum increase of the relaxation time
+
+        alignas(CACHE_LINE) T FEQ_[LT::ND] = {0.0};     ///< equilibrium distributions of the far-field state
+
+        /**\brief     Class constructor: no layers
+         *
+         * \param[in] strength    maximum relaxation rate towards the far-field state in [0,1]
+         * \param[in] viscosity   maximum increase of the kinematic viscosity in lattice units
+         * \param[in] rho         far-field density
+         * \param[in] u           far-field velocity in x-direction
+         * \param[in] v           far-field velocity in y-direction
+         * \param[in] w           far-field velocity in z-direction
+        */
+        Sponge(T const strength, T const viscosity, T const rho, T const u, T const v, T const w):
+            STRENGTH_(strength), TAU_(viscosity/(LT::CS*LT::CS)), x_(NX, 0.0), y_(NY, 0.0), z_(NZ, 0.0)
+        {
+            T const uu = - 1.0/(2.0*LT::CS*LT::CS)*(u*u + v*v + w*w);
+
+            for(unsigned int n = 0; n <= 1; ++n)
+            {
+                for(unsigned int d = n; d < LT::HSPEED; ++d)
+                {
+                    unsigned int const curr = n*LT::OFF + d;
+                    T const cu = 1.0/(LT::CS*LT::CS)*(u*LT::DX[curr] + v*LT::DY[curr] + w*LT::DZ[curr]);
+                    FEQ_[curr] = LT::W[curr]*(rho + rho*(cu*(1.0 + 0.5*cu) + uu));
+                }
+            }
+        }
+
+        /**\fn        AddLayer
+         * \brief     Add an absorbing layer in front of a boundary of the domain
+         *
+         * \tparam    Orientation   orientation of the boundary (normal pointing into the fluid volume)
+         * \param[in] width         width of the layer in cells
+        */
+        template <class Orientation>
+        void AddLayer(unsigned int const width)
+        {
+            Ramp(x_, Orientation::x, width);
+            Ramp(y_, Orientation::y, width);
+            Ramp(z_, Orientation::z, width);
+        }
+
+        /**\fn        Profile
+         * \brief     Local strength of the absorbing layers
+         * \warning   Inline function! Called from within the kernels.
+         *
+         * \param[in] x   x coordinate of cell
+         * \param[in] y   y coordinate of cell
+         * \param[in] z   z coordinate of cell
+         * \return    Value in [0,1]: zero outside of all layers and one at the boundary
+        */
+        inline T __attribute__((always_inline)) Profile(unsigned int const x, unsigned int const y, unsigned int const z) const
+        {
+            return std::max(x_[x], std::max(y_[y], z_[z]));
+        }
+
+    private:
+        std::vector<T> x_;      ///< profile in x-direction
+        std::vector<T> y_;      ///< profile in y-direction
+        std::vector<T> z_;      ///< profile in z-direction
+
+        /**\fn        Ramp
+         * \brief     Add a quadratic ramp to a profile
+         *
+         * \param[in,out] profile   profile in the normal direction of the boundary
+         * \param[in]     normal    normal direction pointing into the fluid (0: no layer)
+         * \param[in]     width     width of the layer in cells
+        */
+        static void Ramp(std::vector<T>& profile, int const normal, unsigned int const width)
+        {
+            if ((normal == 0) || (width == 0))
+            {
+                return;
+            }
+
+            size_t const SIZE = profile.size();
+            for(size_t i = 0; i < std::min(static_cast<size_t>(width), SIZE); ++i)
+            {
+                // distance i from the boundary
+                T const ramp = static_cast<T>(width - i)/width;
+                size_t const j = (normal > 0) ? i : SIZE - 1 - i;
+                profile[j] = std::max(profile[j], ramp*ramp);
+            }
+        }
+};
+
+#endif // BOUNDARY_SPONGE_HPP_INCLUDED
@@ -0,0 +1,334 @@
+#ifndef BOUNDARY_WALL_FUNCTION_HPP_INCLUDED
+#define BOUNDARY_WALL_FUNCTION_HPP_INCLUDED
+
+/**
+ * \file     boundary_wall_function.hpp
+ * \mainpage Wall function for large-eddy simulations with coarse near-wall resolution
+ * \note     "Wall model for large-eddy simulation based on the lattice Boltzmann method"
+ *           O. Malaspinas, P. Sagaut
+ *           Journal of Computational Physics 275 (2014)
+ *           DOI: 10.1016/j.jcp.2014.06.020
+ *
+ *           "A single formula for the law of the wall"
+ *           D.B. Spalding
+ *           Journal of Applied Mechanics 28 (1961)
+ *           DOI: 10.1115/1.3641728
+ *
+ *           The wall shear stress is determined from the tangential velocity of the first fluid cell
+ *           off a planar wall by Spalding's law of the wall, that holds in the viscous sublayer as
+ *           well as in the logarithmic region. The populations reflected by the wall are turned from
+ *           a bounce-back into a specular reflection that does not exert any shear on the fluid, the
+ *           momentum of the cell is then reduced by the impulse of the wall shear stress. Finally the
+ *           populations are regularised: they are replaced by the equilibrium and the
+ *           non-equilibrium part reconstructed from the momentum flux tensor, where the shear
+ *           components normal to the wall are replaced by the wall shear stress. The stress is
+ *           converted to the non-equilibrium momentum flux with the effective relaxation time of the
+ *           node, the laminar one increased by the eddy viscosity of the Smagorinsky kernel. The
+ *           nodes are processed in chunks so that the non-linear equation is solved by a fixed number
+ *           of Newton iterations vectorised over the boundary list.
+*/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+#include "../../general/memory_alignment.hpp"
+#include "boundary_list.hpp"
+#include "../population.hpp"
+
+
+/**\fn        ExpNonNegative
+ * \brief     Exponential function of non-negative arguments that can be vectorised by the compiler:
+ *            exp(x) = 2^n exp(r) with the nearest integer n of x/ln(2) and a polynomial for |r| <= ln(2)/2
+ * \note      The exponential of the standard library is only vectorised with -ffast-math.
+ *
+ * \tparam    T   floating data type
+ * \param[in] x   non-negative argument that does not overflow the result
+ * \return    The exponential of \param x accurate to round-off
+*/
+template <typename T>
+inline T ExpNonNegative(T const x)
+{
+    typedef typename std::conditional<sizeof(T) == sizeof(int64_t), int64_t, int32_t>::type I;
+
+    /// ln(2) split in a part exact in double precision and the remainder
+    constexpr T  LOG2E = 1.4426950408889634;
+    constexpr T LN2_HI = 6.93147180369123816490e-01;
+    constexpr T LN2_LO = 1.90821492927058770002e-10;
+
+    int32_t const n = static_cast<int32_t>(x*LOG2E + 0.5);
+    T const r = (x - static_cast<T>(n)*LN2_HI) - static_cast<T>(n)*LN2_LO;
+
+    // Taylor polynomial of degree 12 for exp(r)
+    T e = 1.0/479001600.0;
+    e = e*r + 1.0/39916800.0;
+    e = e*r + 1.0/3628800.0;
+    e = e*r + 1.0/362880.0;
+    e = e*r + 1.0/40320.0;
+    e = e*r + 1.0/5040.0;
+    e = e*r + 1.0/720.0;
+    e = e*r + 1.0/120.0;
+    e = e*r + 1.0/24.0;
+    e = e*r + 1.0/6.0;
+    e = e*r + 0.5;
+    e = e*r + 1.0;
+    e = e*r + 1.0;
+
+    // 2^n: biased exponent shifted into the exponent bits
+    I const bits = static_cast<I>(n + std::numeric_limits<T>::max_exponent - 1) << (std::numeric_limits<T>::digits - 1);
+    T scale;
+    memcpy(&scale, &bits, sizeof(T));
+
+    return e*scale;
+}
+
+/**\fn         WallFunction
+ * \brief      Impose the wall shear stress of the law of the wall on the first fluid cells off a
+ *             planar wall
+ * \warning    Has to be called before the collision of the first fluid cells. The solid cells of the
+ *             wall have to be treated by halfway bounce-back (e.g. BounceBackHalfway or Bouzidi links
+ *             at q = 1/2) after the collision of the previous time step. All populations of the first
+ *             fluid cells are overwritten.
+ *
+ * \tparam     odd           even (0, false) or odd (1, true) time step
+ * \tparam     Orientation   wall orientation (normal pointing into the fluid volume, e.g. orientation::Bottom)
+ * \tparam     NX            simulation domain resolution in x-direction
+ * \tparam     NY            simulation domain resolution in y-direction
+ * \tparam     NZ            simulation domain resolution in z-direction
+ * \tparam     LT            static lattice::DdQq class containing discretisation parameters
+ * \param[in]  boundary      compact list holding the first fluid cells off the wall
+ * \param[out] pop           population object holding microscopic variables
+ * \param[in]  distance      distance of the cell centres from the wall (default = 0.5: halfway)
+ * \param[in]  smagorinsky   Smagorinsky constant of the collision kernel (default = 0.15 as in
+ *                           CollideStreamBGK_Smagorinsky, 0 for laminar kernels)
+ * \param[in]  p             relevant population (default = 0)
+*/
+template <bool odd, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, class LT>
+void WallFunction(BoundaryList<NX,NY,NZ,LT,Orientation> const& boundary, Population<NX,NY,NZ,LT>& pop,
+                  typename Population<NX,NY,NZ,LT>::T const distance = 0.5,
+                  typename Population<NX,NY,NZ,LT>::T const smagorinsky = 0.15, unsigned int const p = 0)
+{
+    typedef typename Population<NX,NY,NZ,LT>::T T;
+
+    static_assert((Orientation::x != 0) + (Orientation::y != 0) + (Orientation::z != 0) == 1,
+                  "Wall function requires a wall normal to one of the axes.");
+
+    /// wall normal: axis and direction pointing into the fluid
+    constexpr unsigned int AXIS = (Orientation::x != 0) ? 0 : ((Orientation::y != 0) ? 1 : 2);
+    constexpr T          NORMAL = Orientation::x + Orientation::y + Orientation::z;
+
+    /// law of the wall
+    constexpr T                 KAPPA = 0.41;
+    constexpr T                     B = 5.2;
+    constexpr unsigned int ITERATIONS = 8;
+
+    /// Newton iterations for the effective relaxation time that depends on the momentum flux itself
+    constexpr unsigned int EDDY_ITERATIONS = 3;
+
+    /// nodes processed together
+    constexpr size_t CHUNK = 64;
+
+    T const E   = std::exp(-KAPPA*B);
+    T const R_Y = distance/pop.NU_;
+    T const C_T = 2.0*std::sqrt(2.0)*smagorinsky*smagorinsky/(LT::CS*LT::CS*LT::CS*LT::CS);
+    // bound of u+ (y+ ~ 1e16): keeps the exponential finite in single precision
+    T const U_MAX = 100.0;
+
+    /// populations entering from the wall: bounce-back reverses the tangential components of the
+    //  lattice velocity as well, the specular reflection is held by the population with the opposite ones
+    std::array<unsigned int,LT::ND> mirror = {};
+    for(unsigned int i = 0; i < LT::ND; ++i)
+    {
+        int const c[3] = { static_cast<int>(LT::DX[i]), static_cast<int>(LT::DY[i]), static_cast<int>(LT::DZ[i]) };
+        for(unsigned int k = 0; k < LT::ND; ++k)
+        {
+            int const m[3] = { static_cast<int>(LT::DX[k]), static_cast<int>(LT::DY[k]), static_cast<int>(LT::DZ[k]) };
+            bool match = (LT::MASK[k] > 0.5);
+            for(unsigned int a = 0; a < 3; ++a)
+            {
+                match = match && (m[a] == ((a == AXIS) ? c[a] : -c[a]));
+            }
+            mirror[i] = ((LT::MASK[i] > 0.5) && (match == true)) ? k : mirror[i];
+        }
+    }
+
+    #pragma omp parallel for default(none) shared(boundary,pop,mirror) firstprivate(p,E,R_Y,C_T,U_MAX) schedule(static)
+    for(size_t chunk = 0; chunk < boundary.SIZE_; chunk += CHUNK)
+    {
+        unsigned int const num = static_cast<unsigned int>((boundary.SIZE_ - chunk < CHUNK) ? boundary.SIZE_ - chunk : CHUNK);
+
+        alignas(CACHE_LINE) T f[CHUNK*LT::ND];
+        alignas(CACHE_LINE) T rho[CHUNK];
+        alignas(CACHE_LINE) T vel[3][CHUNK];
+        alignas(CACHE_LINE) T u_t[CHUNK];
+        alignas(CACHE_LINE) T R[CHUNK];
+        alignas(CACHE_LINE) T u_p[CHUNK];
+
+        /// gather populations with specular reflection at the wall and macroscopic values
+        for(unsigned int j = 0; j < num; ++j)
+        {
+            T r   = 0.0;
+            T j_x = 0.0;
+            T j_y = 0.0;
+            T j_z = 0.0;
+
+            #pragma GCC unroll (2)
+            for(unsigned int n = 0; n <= 1; ++n)
+            {
+                #pragma GCC unroll (16)
+                for(unsigned int d = n; d < LT::HSPEED; ++d)
+                {
+                    unsigned int const curr = n*LT::OFF + d;
+                    T const c_n = NORMAL*((AXIS == 0) ? LT::DX[curr] : ((AXIS == 1) ? LT::DY[curr] : LT::DZ[curr]));
+                    unsigned int const read = (c_n > 0.0) ? mirror[curr] : curr;
+
+                    T const f_i = pop.F_[boundary. template IndexRead<odd>(chunk + j,read/LT::OFF,read%LT::OFF,p)];
+                    f[j*LT::ND + curr] = f_i;
+                    r   += f_i;
+                    j_x += f_i*LT::DX[curr];
+                    j_y += f_i*LT::DY[curr];
+                    j_z += f_i*LT::DZ[curr];
+                }
+            }
+
+            rho[j]    = r;
+            vel[0][j] = j_x/r;
+            vel[1][j] = j_y/r;
+            vel[2][j] = j_z/r;
+
+            // magnitude of the velocity parallel to the wall
+            T uu_t = 0.0;
+            for(unsigned int a = 0; a < 3; ++a)
+            {
+                uu_t += (a != AXIS) ? vel[a][j]*vel[a][j] : 0.0;
+            }
+            u_t[j] = std::sqrt(uu_t);
+
+            // local Reynolds number R = y u_t/nu and initial guess of u+: viscous sublayer or logarithmic region
+            R[j] = std::max(R_Y*u_t[j], static_cast<T>(1.0e-12));
+            T const u_0 = std::min(std::sqrt(R[j]), std::log(1.0 + R[j])/KAPPA + B);
+            u_p[j] = (u_0 < U_MAX) ? u_0 : U_MAX;
+        }
+
+        /// friction velocity from Spalding's law y+ = u+ + E (exp(k u+) - 1 - k u+ - (k u+)^2/2 - (k u+)^3/6)
+        //  solved for u+ with y+ = R/u+: one vectorised loop over the chunk per Newton iteration
+        for(unsigned int it = 0; it < ITERATIONS; ++it)
+        {
+            #pragma omp simd aligned(R,u_p:CACHE_LINE)
+            for(unsigned int j = 0; j < num; ++j)
+            {
+                T const u  = u_p[j];
+                T const k  = KAPPA*u;
+                T const e  = ExpNonNegative(k);
+                T const g  = u + E*(e - 1.0 - k - 0.5*k*k - k*k*k/6.0) - R[j]/u;
+                T const dg = 1.0 + E*KAPPA*(e - 1.0 - k - 0.5*k*k) + R[j]/(u*u);
+                T const u_n = std::max(u - g/dg, static_cast<T>(1.0e-3)*u);
+                u_p[j] = (u_n < U_MAX) ? u_n : U_MAX;
+            }
+        }
+
+        /// scatter regularised populations
+        for(unsigned int j = 0; j < num; ++j)
+        {
+            // impulse of the wall shear stress rho u_tau^2 = rho (u_t/u+)^2 against the tangential velocity
+            T const r     = rho[j];
+            T const u_tau = u_t[j]/u_p[j];
+            T const slip  = std::max(1.0 - u_tau/u_p[j], 0.0);
+            T const u = (AXIS == 0) ? 0.0 : slip*vel[0][j];
+            T const v = (AXIS == 1) ? 0.0 : slip*vel[1][j];
+            T const w = (AXIS == 2) ? 0.0 : slip*vel[2][j];
+            T const uu = - 1.0/(2.0*LT::CS*LT::CS)*(u*u + v*v + w*w);
+
+            // equilibrium distributions and non-equilibrium momentum flux
+            alignas(CACHE_LINE) T feq[LT::ND] = {0.0};
+            T pi[3][3] = {{0.0}};
+
+            #pragma GCC unroll (2)
+            for(unsigned int n = 0; n <= 1; ++n)
+            {
+                #pragma GCC unroll (16)
+                for(unsigned int d = n; d < LT::HSPEED; ++d)
+                {
+                    unsigned int const curr = n*LT::OFF + d;
+                    T const cu = 1.0/(LT::CS*LT::CS)*(u*LT::DX[curr] + v*LT::DY[curr] + w*LT::DZ[curr]);
+                    feq[curr] = LT::W[curr]*(r + r*(cu*(1.0 + 0.5*cu) + uu));
+
+                    T const fneq = f[j*LT::ND + curr] - feq[curr];
+                    T const c[3] = { LT::DX[curr], LT::DY[curr], LT::DZ[curr] };
+                    for(unsigned int a = 0; a < 3; ++a)
+                    {
+                        for(unsigned int b = 0; b < 3; ++b)
+                        {
+                            pi[a][b] += c[a]*c[b]*fneq;
+                        }
+                    }
+                }
+            }
+
+            // shear components normal to the wall: wall shear stress in direction of the tangential velocity
+            // converted with the effective relaxation time tau_e of the kernel, -tau_e/(tau_e - 1/2) sigma.
+            // The eddy viscosity depends on the magnitude |pi| of the flux itself:
+            // (tau_e - tau) tau_e = C |pi|/(4 rho) solved by Newton's method starting from the root
+            // (tau_e - tau)(tau_e - 1/2) = C sqrt(2) sigma/(4 rho) without the remaining components pp
+            T pp = 0.0;
+            for(unsigned int a = 0; a < 3; ++a)
+            {
+                for(unsigned int b = 0; b < 3; ++b)
+                {
+                    pp += ((a == AXIS) != (b == AXIS)) ? 0.0 : pi[a][b]*pi[a][b];
+                }
+            }
+
+            T const sigma = r*u_tau*u_tau;
+            T const     K = 0.25*C_T*std::sqrt(2.0)*sigma/r;
+            T tau_e = 0.5*(pop.TAU_ + 0.5 + std::sqrt((pop.TAU_ - 0.5)*(pop.TAU_ - 0.5) + 4.0*K));
+            for(unsigned int it = 0; it < EDDY_ITERATIONS; ++it)
+            {
+                T const q   = tau_e/(tau_e - 0.5);
+                T const dq  = - 0.5/((tau_e - 0.5)*(tau_e - 0.5));
+                T const p_n = std::sqrt(pp + 2.0*q*q*sigma*sigma);
+                T const g   = (tau_e - pop.TAU_)*tau_e - 0.25*C_T*p_n/r;
+                T const dg  = 2.0*tau_e - pop.TAU_ - 0.5*C_T*q*dq*sigma*sigma/(p_n*r);
+                tau_e -= g/dg;
+            }
+            T const t_s = (u_t[j] > 0.0) ? - NORMAL*tau_e/(tau_e - 0.5)*sigma/u_t[j] : 0.0;
+
+            for(unsigned int a = 0; a < 3; ++a)
+            {
+                if (a != AXIS)
+                {
+                    pi[a][AXIS] = t_s*vel[a][j];
+                    pi[AXIS][a] = pi[a][AXIS];
+                }
+            }
+
+            #pragma GCC unroll (2)
+            for(unsigned int n = 0; n <= 1; ++n)
+            {
+                #pragma GCC unroll (16)
+                for(unsigned int d = n; d < LT::HSPEED; ++d)
+                {
+                    unsigned int const curr = n*LT::OFF + d;
+                    T const c[3] = { LT::DX[curr], LT::DY[curr], LT::DZ[curr] };
+
+                    T qp = 0.0;
+                    for(unsigned int a = 0; a < 3; ++a)
+                    {
+                        for(unsigned int b = 0; b < 3; ++b)
+                        {
+                            qp += (c[a]*c[b] - ((a == b) ? LT::CS*LT::CS : 0.0))*pi[a][b];
+                        }
+                    }
+
+                    pop.F_[boundary. template IndexRead<odd>(chunk + j,n,d,p)] = feq[curr] + LT::W[curr]/(2.0*LT::CS*LT::CS*LT::CS*LT::CS)*qp;
+                }
+            }
+        }
+    }
+}
+
+#endif // BOUNDARY_WALL_FUNCTION_HPP_INCLUDED
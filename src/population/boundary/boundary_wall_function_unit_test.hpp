@@ -0,0 +1,142 @@
+#ifndef BOUNDARY_WALL_FUNCTION_UNIT_TEST_HPP_INCLUDED
+#define BOUNDARY_WALL_FUNCTION_UNIT_TEST_HPP_INCLUDED
+
+/**
+ * \file     boundary_wall_function_unit_test.hpp
+ * \mainpage Regression test for the wall function: wall stress and log-law velocity of the first cell
+*/
+
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+#include "../../continuum/continuum.hpp"
+#include "../../lattice/D3Q19.hpp"
+#include "../collision/collision_bgk-s.hpp"
+#include "../initialisation.hpp"
+#include "../macroscopic.hpp"
+#include "../population.hpp"
+#include "boundary.hpp"
+#include "boundary_bounceback.hpp"
+#include "boundary_list.hpp"
+#include "boundary_orientation.hpp"
+#include "boundary_wall_function.hpp"
+
+
+/**\fn     UnitTestWallFunction
+ * \brief  Pressure-driven turbulent channel resolved by a single column of cells with the first cell
+ *         at y+ = 100, 1000 and 10000. In the steady state the wall stress has to balance the driving
+ *         force and the velocity of the first cell has to follow the logarithmic law of the wall.
+ *
+ * \return EXIT_SUCCESS if the test passed, else EXIT_FAILURE
+*/
+inline int UnitTestWallFunction()
+{
+    constexpr unsigned int NX = 1;
+    constexpr unsigned int NY = 1;
+    constexpr unsigned int NZ = 10;
+    constexpr unsigned int NT = 200000;
+    constexpr unsigned int INTERVAL = 2000;
+    typedef lattice::D3Q19<double> DdQq;
+
+    constexpr double KAPPA = 0.41;
+    constexpr double     B = 5.2;
+    constexpr double U_TAU = 0.003;
+    constexpr double     H = NZ - 2;
+
+    /// solid walls at z = 0 and z = NZ-1, wall function on the first fluid cells (half a cell from the wall)
+    std::vector<boundaryElement<double>> wall;
+    std::vector<boundaryElement<double>> bottom;
+    std::vector<boundaryElement<double>> top;
+    wall.push_back({0, 0, 0,    1.0, 0.0, 0.0, 0.0, 0});
+    wall.push_back({0, 0, NZ-1, 1.0, 0.0, 0.0, 0.0, 0});
+    bottom.push_back({0, 0, 1,    1.0, 0.0, 0.0, 0.0, 0});
+    top.push_back(   {0, 0, NZ-2, 1.0, 0.0, 0.0, 0.0, 0});
+    BoundaryList<NX,NY,NZ,DdQq> const Wall(wall);
+    BoundaryList<NX,NY,NZ,DdQq,orientation::Bottom> const Bottom(bottom);
+    BoundaryList<NX,NY,NZ,DdQq,orientation::Top>    const Top(top);
+
+    /// driving force per cell balanced by the wall stress u_tau^2 on both walls
+    std::vector<double> force(3*NX*NY*NZ, 0.0);
+    for(unsigned int z = 0; z < NZ; ++z)
+    {
+        force[3*z] = U_TAU*U_TAU/(0.5*H);
+    }
+
+    int result = EXIT_SUCCESS;
+    for(double const RE_TAU: {100.0*H, 1000.0*H, 10000.0*H})
+    {
+        /// friction Reynolds number with respect to the half channel height: y+ of the first cell is RE_TAU/H
+        Continuum<NX,NY,NZ,double> Macro;
+        Population<NX,NY,NZ,DdQq>  Micro(RE_TAU, U_TAU, 0.5*H);
+        Micro.flags_.Set(wall, SOLID);
+        Micro.flags_.Update();
+        double const yPlus = 0.5*U_TAU/Micro.NU_;
+
+        /// start from the logarithmic profile
+        for(unsigned int z = 0; z < NZ; ++z)
+        {
+            double const distance = (z < NZ/2) ? z - 0.5 : NZ - 1.5 - z;
+            Macro(0,0,z,0) = 1.0;
+            Macro(0,0,z,1) = (distance > 0.0) ? U_TAU*(std::log(distance*U_TAU/Micro.NU_)/KAPPA + B) : 0.0;
+            Macro(0,0,z,2) = 0.0;
+            Macro(0,0,z,3) = 0.0;
+        }
+        InitLattice<false>(Macro, Micro);
+
+        /// momentum of the fluid right after the wall function (fills the macroscopic values)
+        auto const Momentum = [&]() -> double
+        {
+            ComputeMacroscopic<false>(Macro, Micro, 0);
+            double momentum = 0.0;
+            for(unsigned int z = 1; z < NZ-1; ++z)
+            {
+                momentum += Macro(0,0,z,0)*Macro(0,0,z,1);
+            }
+            return momentum;
+        };
+
+        double before = 0.0;
+        for(unsigned int i = 0; i < NT; i += 2)
+        {
+            WallFunction<false>(Bottom, Micro);
+            WallFunction<false>(Top, Micro);
+            if (i == NT - INTERVAL)
+            {
+                before = Momentum();
+            }
+            CollideStreamBGK_Smagorinsky<false>(Macro, Micro, 0, 0, Micro.NUM_BLOCKS_, nullptr, force.data());
+            BounceBackHalfway<false>(Wall, Micro);
+
+            WallFunction<true>(Bottom, Micro);
+            WallFunction<true>(Top, Micro);
+            CollideStreamBGK_Smagorinsky<true>(Macro, Micro, 0, 0, Micro.NUM_BLOCKS_, nullptr, force.data());
+            BounceBackHalfway<true>(Wall, Micro);
+        }
+        WallFunction<false>(Bottom, Micro);
+        WallFunction<false>(Top, Micro);
+        double const after = Momentum();
+
+        /// wall stress from the momentum balance of the channel
+        double const stress = 0.5*(force[0]*H - (after - before)/INTERVAL)/(U_TAU*U_TAU);
+        double const uPlus  = 0.5*(Macro(0,0,1,1) + Macro(0,0,NZ-2,1))/U_TAU;
+        double const logLaw = std::log(yPlus)/KAPPA + B;
+
+        if ((std::isfinite(stress) == false) || (std::abs(stress - 1.0) > 0.01))
+        {
+            std::cerr << "Error: Wall stress of " << stress << " u_tau^2 at y+ = " << yPlus << "." << std::endl;
+            result = EXIT_FAILURE;
+        }
+        if ((std::isfinite(uPlus) == false) || (std::abs(uPlus - logLaw) > 0.02*logLaw))
+        {
+            std::cerr << "Error: Velocity of the first cell u+ = " << uPlus << " differs from the log law "
+                      << logLaw << " at y+ = " << yPlus << "." << std::endl;
+            result = EXIT_FAILURE;
+        }
+    }
+
+    return result;
+}
+
+#endif // BOUNDARY_WALL_FUNCTION_UNIT_TEST_HPP_INCLUDED
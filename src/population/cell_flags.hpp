@@ -0,0 +1,240 @@
+#ifndef CELL_FLAGS_HPP_INCLUDED
+#define CELL_FLAGS_HPP_INCLUDED
+
+/**
+ * \file     cell_flags.hpp
+ * \mainpage Bit-packed field holding the type of every cell of the domain
+ *
+ * \note     Solid cells that are not adjacent to any fluid cell neither have to be collided nor
+ *           bounced back: their populations are only exchanged with other solid cells and are
+ *           overwritten by the bounce-back of the surface cells before a fluid cell reads them.
+ *           The type of every cell is stored in bit planes with one bit per cell and rows in
+ *           x-direction padded to 64 bit, so that the kernels skip entire runs of solid cells by a
+ *           single bit scan and loop blocks that are completely solid are not processed at all.
+ *           Inlet and outlet cells are not flagged: they are held by their boundary lists.
+*/
+
+#include <algorithm>
+#include <iostream>
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../general/constexpr_func.hpp"
+#include "boundary/boundary.hpp"
+
+
+/**\enum  cellType
+ * \brief Type of a cell: fluid cells are not flagged, all other types correspond to a bit plane
+*/
+enum cellType : unsigned int
+{
+    FLUID    = 0,
+    SOLID    = 1    ///< solid cell (bounce-back)
+};
+
+
+/**\class  CellFlags
+ * \brief  Bit planes holding the type of every cell and the completely solid loop blocks
+ *
+ * \tparam NX           simulation domain resolution in x-direction
+ * \tparam NY           simulation domain resolution in y-direction
+ * \tparam NZ           simulation domain resolution in z-direction
+ * \tparam BLOCK_SIZE   loop block size of the population
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, unsigned int BLOCK_SIZE>
+class CellFlags
+{
+    public:
+        static constexpr unsigned int  PLANES_ = 1;                             ///< number of bit planes (all types but fluid)
+        static constexpr unsigned int   WORDS_ = (NX + 63) / 64;                ///< 64-bit words per row in x-direction
+        static constexpr size_t     MEM_WORDS_ = static_cast<size_t>(PLANES_)*NZ*NY*WORDS_;
+
+        /// loop blocks
+        static constexpr unsigned int NUM_BLOCKS_Z_ = cef::ceil(static_cast<double>(NZ) / BLOCK_SIZE);
+        static constexpr unsigned int NUM_BLOCKS_Y_ = cef::ceil(static_cast<double>(NY) / BLOCK_SIZE);
+        static constexpr unsigned int NUM_BLOCKS_X_ = cef::ceil(static_cast<double>(NX) / BLOCK_SIZE);
+        static constexpr unsigned int   NUM_BLOCKS_ = NUM_BLOCKS_X_*NUM_BLOCKS_Y_*NUM_BLOCKS_Z_;
+
+        std::vector<uint64_t>      bits_;           ///< bit planes [type-1][z][y][word]
+        std::vector<unsigned char> solidBlock_;     ///< loop block consists of solid cells only
+
+        /**\brief Class constructor: all cells are fluid
+        */
+        CellFlags():
+            bits_(MEM_WORDS_, 0), solidBlock_(NUM_BLOCKS_, 0)
+        {
+        }
+
+        /**\fn        Set
+         * \brief     Flag a cell with a certain type (in addition to existing ones)
+         *
+         * \param[in] x      x coordinate of cell
+         * \param[in] y      y coordinate of cell
+         * \param[in] z      z coordinate of cell
+         * \param[in] type   type of the cell
+        */
+        void Set(unsigned int const x, unsigned int const y, unsigned int const z, cellType const type)
+        {
+            if (type != FLUID)
+            {
+                bits_[Row(type, y, z) + x/64] |= static_cast<uint64_t>(1) << (x % 64);
+            }
+        }
+
+        /**\fn        Set
+         * \brief     Flag all cells of a vector of boundary elements with a certain type
+         *
+         * \param[in] elements   vector holding boundary elements
+         * \param[in] type       type of the cells
+        */
+        template <typename T>
+        void Set(std::vector<boundaryElement<T>> const& elements, cellType const type)
+        {
+            for(size_t i = 0; i < elements.size(); ++i)
+            {
+                Set(elements[i].x, elements[i].y, elements[i].z, type);
+            }
+        }
+
+        /**\fn        Is
+         * \brief     Determine if a cell is of a certain type
+         * \warning   Inline function! Called from within the kernels.
+         *
+         * \param[in] x      x coordinate of cell
+         * \param[in] y      y coordinate of cell
+         * \param[in] z      z coordinate of cell
+         * \param[in] type   type of the cell
+         * \return    True if the cell is of the given type
+        */
+        inline bool __attribute__((always_inline)) Is(unsigned int const x, unsigned int const y, unsigned int const z, cellType const type) const
+        {
+            bool const solid = (bits_[Row(SOLID, y, z) + x/64] >> (x % 64)) & 1;
+            return (type == FLUID) ? !solid : solid;
+        }
+
+        /**\fn        NextFluid
+         * \brief     First cell of a row in x-direction that is not solid, skipping solid runs
+         * \warning   Inline function! Called from within the kernels.
+         *
+         * \param[in] x       x coordinate of first cell to be considered
+         * \param[in] y       y coordinate of the row
+         * \param[in] z       z coordinate of the row
+         * \param[in] x_end   x coordinate after the last cell to be considered
+         * \return    x coordinate of the next non-solid cell or x_end if there is none
+        */
+        inline unsigned int __attribute__((always_inline)) NextFluid(unsigned int x, unsigned int const y, unsigned int const z,
+                                                                     unsigned int const x_end) const
+        {
+            uint64_t const* const row = bits_.data() + Row(SOLID, y, z);
+
+            while (x < x_end)
+            {
+                uint64_t const open = ~row[x/64] >> (x % 64);
+                if (open != 0)
+                {
+                    return std::min(x + static_cast<unsigned int>(__builtin_ctzll(open)), x_end);
+                }
+                x = (x/64 + 1)*64;
+            }
+
+            return x_end;
+        }
+
+        /**\fn        IsSolidBlock
+         * \brief     Determine if a loop block consists of solid cells only
+         * \warning   Inline function! Called from within the kernels.
+         *
+         * \param[in] block   index of the loop block
+         * \return    True if the block can be skipped
+        */
+        inline bool __attribute__((always_inline)) IsSolidBlock(unsigned int const block) const
+        {
+            return solidBlock_[block] != 0;
+        }
+
+        /**\fn    Update
+         * \brief Determine the completely solid loop blocks. Has to be called after the geometry is set.
+        */
+        void Update()
+        {
+            #pragma omp parallel for default(none) schedule(static)
+            for(unsigned int block = 0; block < NUM_BLOCKS_; ++block)
+            {
+                unsigned int const z_start = BLOCK_SIZE * (block / (NUM_BLOCKS_X_*NUM_BLOCKS_Y_));
+                unsigned int const   z_end = std::min(z_start + BLOCK_SIZE, NZ);
+                unsigned int const y_start = BLOCK_SIZE*((block % (NUM_BLOCKS_X_*NUM_BLOCKS_Y_)) / NUM_BLOCKS_X_);
+                unsigned int const   y_end = std::min(y_start + BLOCK_SIZE, NY);
+                unsigned int const x_start = BLOCK_SIZE*(block % NUM_BLOCKS_X_);
+                unsigned int const   x_end = std::min(x_start + BLOCK_SIZE, NX);
+
+                bool solid = true;
+                for(unsigned int z = z_start; (z < z_end) && (solid == true); ++z)
+                {
+                    for(unsigned int y = y_start; (y < y_end) && (solid == true); ++y)
+                    {
+                        solid = (NextFluid(x_start, y, z, x_end) == x_end);
+                    }
+                }
+                solidBlock_[block] = solid;
+            }
+        }
+
+        /**\fn        Surface
+         * \brief     Solid elements adjacent to at least one non-solid cell: only these have to be
+         *            treated by bounce-back
+         *
+         * \param[in] wall   vector holding solid elements
+         * \return    Vector holding the solid elements on the surface
+        */
+        template <typename T>
+        std::vector<boundaryElement<T>> Surface(std::vector<boundaryElement<T>> const& wall) const
+        {
+            std::vector<boundaryElement<T>> surface;
+
+            for(size_t i = 0; i < wall.size(); ++i)
+            {
+                if (HasOpenNeighbour(wall[i].x, wall[i].y, wall[i].z) == true)
+                {
+                    surface.push_back(wall[i]);
+                }
+            }
+
+            return surface;
+        }
+
+    private:
+        /**\fn        Row
+         * \brief     First word of a row in x-direction of a bit plane
+        */
+        static inline size_t __attribute__((always_inline)) Row(cellType const type, unsigned int const y, unsigned int const z)
+        {
+            return ((static_cast<size_t>(type - 1)*NZ + z)*NY + y)*WORDS_;
+        }
+
+        /**\fn        HasOpenNeighbour
+         * \brief     Determine if any of the 26 neighbours (periodic) of a cell is not solid
+        */
+        bool HasOpenNeighbour(unsigned int const x, unsigned int const y, unsigned int const z) const
+        {
+            for(int k = -1; k <= 1; ++k)
+            {
+                for(int j = -1; j <= 1; ++j)
+                {
+                    for(int i = -1; i <= 1; ++i)
+                    {
+                        if (Is((NX + x + i) % NX, (NY + y + j) % NY, (NZ + z + k) % NZ, SOLID) == false)
+                        {
+                            return true;
+                        }
+                    }
+                }
+            }
+            return false;
+        }
+};
+
+#endif // CELL_FLAGS_HPP_INCLUDED
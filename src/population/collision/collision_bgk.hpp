@@ -8,12 +8,19 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
 #if __has_include (<omp.h>)
     #include <omp.h>
 #endif
 
 #include "../../general/memory_alignment.hpp"
+#include "../../general/parallelism.hpp"
 #include "../../continuum/continuum.hpp"
+#include "../../continuum/monitor.hpp"
+#include "../../continuum/statistics.hpp"
+#include "../boundary/boundary_sponge.hpp"
 #include "../population.hpp"
 
 /**\fn            CollideStreamBGK
@@ -25,117 +32,254 @@
  *                DOI: 10.1103/PhysRev.94.511
  *
  * \tparam        odd    even (0, false) or odd (1, true) time step
+ * \tparam        save   save current macroscopic values to continuum (default = false)
  * \tparam        NX     simulation domain resolution in x-direction
  * \tparam        NY     simulation domain resolution in y-direction
  * \tparam        NZ     simulation domain resolution in z-direction
  * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam        PROP   propagation pattern (e.g. propagation::AA)
  * \tparam        T      floating data type used for simulation
- * \param[out]    con    continuum object holding macroscopic variables
+ * \tparam        STATS  Statistics<NX,NY,NZ,T>* or std::nullptr_t (deduced: nullptr removes the statistics)
+ * \tparam        FORCE  T const* or std::nullptr_t (deduced: nullptr removes the forcing)
+ * \tparam        SPONGE Sponge<NX,NY,NZ,LT> const* or std::nullptr_t (deduced: nullptr removes the layers)
+ * \tparam        MONITOR Monitor<NX,NY,NZ,T>* or std::nullptr_t (deduced: nullptr removes the diagnostics)
+ * \param[out]    con    continuum object holding macroscopic variables (only written if save)
  * \param[in,out] pop    population object holding microscopic variables
- * \param[in]     save   save current macroscopic values to disk (Boolean true/false)
  * \param[in]     p      relevant population (default = 0)
+ * \param[in]     block_begin   first loop block (default = 0)
+ * \param[in]     block_end     loop block after the last one (default = all blocks)
+ * \param[in,out] stats         statistics accumulated in this time step (default = nullptr: none,
+ *                              a null pointer of type STATS skips them at run time)
+ * \param[in]     force         external force density [Fx,Fy,Fz] per cell added with Guo forcing
+ *                              (default = nullptr: kernel without forcing)
+ * \param[in]     sponge        absorbing layers (default = nullptr: kernel without layers)
+ * \param[in,out] monitor       global diagnostics accumulated in this time step (default = nullptr:
+ *                              none, a null pointer of type MONITOR skips them at run time)
 */
-template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, typename T>
-void CollideStreamBGK(Continuum<NX,NY,NZ,T>& con, Population<NX,NY,NZ,LT>& pop, bool const save = false, unsigned int const p = 0)
+template <bool odd, bool save = false, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class PROP, typename T,
+          class STATS = std::nullptr_t, class FORCE = std::nullptr_t, class SPONGE = std::nullptr_t, class MONITOR = std::nullptr_t>
+void CollideStreamBGK(Continuum<NX,NY,NZ,T>& con, Population<NX,NY,NZ,LT,1,PROP>& pop, unsigned int const p = 0,
+                      unsigned int const block_begin = 0, unsigned int const block_end = std::numeric_limits<unsigned int>::max(),
+                      [[maybe_unused]] STATS const stats = nullptr, [[maybe_unused]] FORCE const force = nullptr,
+                      [[maybe_unused]] SPONGE const sponge = nullptr, [[maybe_unused]] MONITOR const monitor = nullptr)
 {
-    #pragma omp parallel for default(none) shared(con, pop) firstprivate(save,p) schedule(static,1)
-    for(unsigned int block = 0; block < pop.NUM_BLOCKS_; ++block)
+    /// optional features: passing nullptr removes them from the kernel at compile time
+    constexpr bool has_stats = (std::is_same<STATS, std::nullptr_t>::value == false);
+    static_assert((has_stats == false) || std::is_convertible<STATS, Statistics<NX,NY,NZ,T>*>::value, "Statistics do not match the continuum.");
+    constexpr bool has_force = (std::is_same<FORCE, std::nullptr_t>::value == false);
+    static_assert((has_force == false) || std::is_convertible<FORCE, T const*>::value, "Force density does not match the floating data type.");
+    constexpr bool has_sponge = (std::is_same<SPONGE, std::nullptr_t>::value == false);
+    static_assert((has_sponge == false) || std::is_convertible<SPONGE, Sponge<NX,NY,NZ,LT> const*>::value, "Sponge does not match the lattice.");
+    constexpr bool has_monitor = (std::is_same<MONITOR, std::nullptr_t>::value == false);
+    static_assert((has_monitor == false) || std::is_convertible<MONITOR, Monitor<NX,NY,NZ,T>*>::value, "Monitor does not match the continuum.");
+
+    unsigned int const block_stop = std::min(block_end, pop.NUM_BLOCKS_);
+    unsigned int const      parts = parallel::ThreadsMax();
+    bool const            measure = pop.schedule_.measure_;
+
+    #pragma omp parallel for default(none) shared(con, pop) firstprivate(p,block_begin,block_stop,parts,measure,stats,force,sponge,monitor) schedule(static,1)
+    for(unsigned int part = 0; part < parts; ++part)
     {
-        unsigned int const z_start = pop.BLOCK_SIZE_ * (block / (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_));
-        unsigned int const   z_end = std::min(z_start + pop.BLOCK_SIZE_, NZ);
+        unsigned int const k_end = pop.schedule_.Begin(part + 1, parts, block_begin, block_stop);
 
-        for(unsigned int z = z_start; z < z_end; ++z)
+        for(unsigned int k = pop.schedule_.Begin(part, parts, block_begin, block_stop); k < k_end; ++k)
         {
-            unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
+            unsigned int const block = pop.order_.Block(k);
+
+            if (pop.flags_.IsSolidBlock(block) == true)
+            {
+                continue;
+            }
+
+            double const start = (measure == true) ? parallel::WallTime() : 0.0;
 
-            unsigned int const y_start = pop.BLOCK_SIZE_*((block % (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_)) / pop.NUM_BLOCKS_X_);
-            unsigned int const   y_end = std::min(y_start + pop.BLOCK_SIZE_, NY);
+            unsigned int const z_start = pop.BLOCK_SIZE_ * (block / (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_));
+            unsigned int const   z_end = std::min(z_start + pop.BLOCK_SIZE_, NZ);
 
-            for(unsigned int y = y_start; y < y_end; ++y)
+            for(unsigned int z = z_start; z < z_end; ++z)
             {
-                unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };
+                unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
 
-                unsigned int const x_start = pop.BLOCK_SIZE_*(block % pop.NUM_BLOCKS_X_);
-                unsigned int const   x_end = std::min(x_start + pop.BLOCK_SIZE_, NX);
+                unsigned int const y_start = pop.BLOCK_SIZE_*((block % (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_)) / pop.NUM_BLOCKS_X_);
+                unsigned int const   y_end = std::min(y_start + pop.BLOCK_SIZE_, NY);
 
-                for(unsigned int x = x_start; x < x_end; ++x)
+                for(unsigned int y = y_start; y < y_end; ++y)
                 {
-                    unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
+                    unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };
 
-                    /// load distributions
-                    alignas(CACHE_LINE) T f[LT::ND] = {0.0};
+                    unsigned int const x_start = pop.BLOCK_SIZE_*(block % pop.NUM_BLOCKS_X_);
+                    unsigned int const   x_end = std::min(x_start + pop.BLOCK_SIZE_, NX);
 
-                    #pragma GCC unroll (2)
-                    for(unsigned int n = 0; n <= 1; ++n)
+                    for(unsigned int x = pop.flags_.NextFluid(x_start, y, z, x_end); x < x_end; x = pop.flags_.NextFluid(x + 1, y, z, x_end))
                     {
-                        #pragma GCC unroll (16)
-                        for(unsigned int d = n; d < LT::HSPEED; ++d)
+                        unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
+
+                        /// load distributions
+                        alignas(CACHE_LINE) T f[LT::ND] = {0.0};
+
+                        #pragma GCC unroll (2)
+                        for(unsigned int n = 0; n <= 1; ++n)
                         {
-                            f[n*LT::OFF + d] = pop.F_[pop. template AA_IndexRead<odd>(x_n,y_n,z_n,n,d,p)];
+                            #pragma GCC unroll (16)
+                            for(unsigned int d = n; d < LT::HSPEED; ++d)
+                            {
+                                f[n*LT::OFF + d] = pop.F_[pop. template AA_IndexRead<odd>(x_n,y_n,z_n,n,d,p)];
+                            }
                         }
-                    }
 
-                    /// macroscopic values
-                    T rho = 0.0;
-                    T u   = 0.0;
-                    T v   = 0.0;
-                    T w   = 0.0;
-                    #pragma GCC unroll (2)
-                    for(unsigned int n = 0; n <= 1; ++n)
-                    {
-                        #pragma GCC unroll (16)
-                        for(unsigned int d = n; d < LT::HSPEED; ++d)
+                        /// macroscopic values
+                        T rho = 0.0;
+                        T u   = 0.0;
+                        T v   = 0.0;
+                        T w   = 0.0;
+                        #pragma GCC unroll (2)
+                        for(unsigned int n = 0; n <= 1; ++n)
                         {
-                            unsigned int const curr = n*LT::OFF + d;
-                            rho += f[curr];
-                            u   += f[curr]*LT::DX[curr];
-                            v   += f[curr]*LT::DY[curr];
-                            w   += f[curr]*LT::DZ[curr];
+                            #pragma GCC unroll (16)
+                            for(unsigned int d = n; d < LT::HSPEED; ++d)
+                            {
+                                unsigned int const curr = n*LT::OFF + d;
+                                rho += f[curr];
+                                u   += f[curr]*LT::DX[curr];
+                                v   += f[curr]*LT::DY[curr];
+                                w   += f[curr]*LT::DZ[curr];
+                            }
                         }
-                    }
-                    u /= rho;
-                    v /= rho;
-                    w /= rho;
 
-                    if (save == true)
-                    {
-                        con(x, y, z, 0) = rho;
-                        con(x, y, z, 1) = u;
-                        con(x, y, z, 2) = v;
-                        con(x, y, z, 3) = w;
-                    }
+                        /// external force density: velocity shifted by half the force (Guo forcing)
+                        T f_x = 0.0;
+                        T f_y = 0.0;
+                        T f_z = 0.0;
+                        if constexpr (has_force == true)
+                        {
+                            size_t const cell = (static_cast<size_t>(z)*NY + y)*NX + x;
+                            f_x = force[3*cell + 0];
+                            f_y = force[3*cell + 1];
+                            f_z = force[3*cell + 2];
+                            u  += 0.5*f_x;
+                            v  += 0.5*f_y;
+                            w  += 0.5*f_z;
+                        }
+                        u /= rho;
+                        v /= rho;
+                        w /= rho;
 
-                    /// equilibrium distributions
-                    alignas(CACHE_LINE) T feq[LT::ND] = {0.0};
+                        if constexpr (save == true)
+                        {
+                            con(x, y, z, 0) = rho;
+                            con(x, y, z, 1) = u;
+                            con(x, y, z, 2) = v;
+                            con(x, y, z, 3) = w;
+                        }
 
-                    T const uu = - 1.0/(2.0*LT::CS*LT::CS)*(u*u + v*v + w*w);
+                        if constexpr (has_stats == true)
+                        {
+                            if (stats != nullptr)
+                            {
+                                stats->Accumulate(x, y, z, rho, u, v, w);
+                            }
+                        }
 
-                    #pragma GCC unroll (2)
-                    for(unsigned int n = 0; n <= 1; ++n)
-                    {
-                        #pragma GCC unroll (16)
-                        for(unsigned int d = n; d < LT::HSPEED; ++d)
+                        if constexpr (has_monitor == true)
                         {
-                            unsigned int const curr = n*LT::OFF + d;
-                            T const cu = 1.0/(LT::CS*LT::CS)*(u*LT::DX[curr] + v*LT::DY[curr] + w*LT::DZ[curr]);
-                            feq[curr] = LT::W[curr]*(rho + rho*(cu*(1.0 + 0.5*cu) + uu));
+                            if (monitor != nullptr)
+                            {
+                                monitor->Accumulate(part, x, y, z, rho, u, v, w);
+                            }
                         }
-                    }
 
-                    /// collision and streaming
-                    #pragma GCC unroll (2)
-                    for(unsigned int n = 0; n <= 1; ++n)
-                    {
-                        #pragma GCC unroll (16)
-                        for(unsigned int d = n; d < LT::HSPEED; ++d)
+                        /// absorbing layers: increased relaxation time and relaxation towards the far field
+                        T tau_s = 0.0;
+                        T sigma = 0.0;
+                        if constexpr (has_sponge == true)
+                        {
+                            T const s = sponge->Profile(x, y, z);
+                            tau_s = s*sponge->TAU_;
+                            sigma = s*sponge->STRENGTH_;
+                        }
+                        T const omega = (tau_s > 0.0) ? 1.0/(pop.TAU_ + tau_s) : pop.OMEGA_;
+
+                        /// equilibrium distributions
+                        alignas(CACHE_LINE) T feq[LT::ND] = {0.0};
+
+                        T const uu = - 1.0/(2.0*LT::CS*LT::CS)*(u*u + v*v + w*w);
+
+                        #pragma GCC unroll (2)
+                        for(unsigned int n = 0; n <= 1; ++n)
                         {
-                            unsigned int const curr = n*LT::OFF + d;
-                            pop.F_[pop. template AA_IndexWrite<odd>(x_n,y_n,z_n,n,d,p)] = f[curr] + pop.OMEGA_*(feq[curr] - f[curr]);
+                            #pragma GCC unroll (16)
+                            for(unsigned int d = n; d < LT::HSPEED; ++d)
+                            {
+                                unsigned int const curr = n*LT::OFF + d;
+                                T const cu = 1.0/(LT::CS*LT::CS)*(u*LT::DX[curr] + v*LT::DY[curr] + w*LT::DZ[curr]);
+                                feq[curr] = LT::W[curr]*(rho + rho*(cu*(1.0 + 0.5*cu) + uu));
+                            }
                         }
+
+                        /// discrete forcing term
+                        alignas(CACHE_LINE) T fs[LT::ND] = {0.0};
+
+                        if constexpr (has_force == true)
+                        {
+                            #pragma GCC unroll (2)
+                            for(unsigned int n = 0; n <= 1; ++n)
+                            {
+                                #pragma GCC unroll (16)
+                                for(unsigned int d = n; d < LT::HSPEED; ++d)
+                                {
+                                    unsigned int const curr = n*LT::OFF + d;
+                                    T const cu = u*LT::DX[curr] + v*LT::DY[curr] + w*LT::DZ[curr];
+                                    T const cf = f_x*LT::DX[curr] + f_y*LT::DY[curr] + f_z*LT::DZ[curr];
+                                    T const uf = u*f_x + v*f_y + w*f_z;
+                                    fs[curr] = (1.0 - 0.5*omega)*LT::W[curr]*((cf - uf)/(LT::CS*LT::CS) + cu*cf/(LT::CS*LT::CS*LT::CS*LT::CS));
+                                }
+                            }
+                        }
+
+                        // absorbing layers: relax the post-collision populations towards the far field
+                        if constexpr (has_sponge == true)
+                        {
+                            if (sigma > 0.0)
+                            {
+                                #pragma GCC unroll (2)
+                                for(unsigned int n = 0; n <= 1; ++n)
+                                {
+                                    #pragma GCC unroll (16)
+                                    for(unsigned int d = n; d < LT::HSPEED; ++d)
+                                    {
+                                        unsigned int const curr = n*LT::OFF + d;
+                                        T const f_post = f[curr] + omega*(feq[curr] - f[curr]) + fs[curr];
+                                        fs[curr] += sigma*(sponge->FEQ_[curr] - f_post);
+                                    }
+                                }
+                            }
+                        }
+
+                        /// collision
+                        #pragma GCC unroll (2)
+                        for(unsigned int n = 0; n <= 1; ++n)
+                        {
+                            #pragma GCC unroll (16)
+                            for(unsigned int d = n; d < LT::HSPEED; ++d)
+                            {
+                                unsigned int const curr = n*LT::OFF + d;
+                                f[curr] = f[curr] + omega*(feq[curr] - f[curr]) + fs[curr];
+                            }
+                        }
+
+                        /// streaming
+                        pop. template WriteCell<odd>(x_n,y_n,z_n,f,p);
                     }
                 }
             }
+
+            if (measure == true)
+            {
+                pop.schedule_.Record(block, parallel::WallTime() - start);
+            }
         }
+
+        pop.Fence();
     }
 }
 
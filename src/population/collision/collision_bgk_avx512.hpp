@@ -9,12 +9,18 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
 #if __has_include (<omp.h>)
     #include <omp.h>
 #endif
 
 #include "../../general/memory_alignment.hpp"
+#include "../../general/parallelism.hpp"
 #include "../../continuum/continuum.hpp"
+#include "../../continuum/monitor.hpp"
+#include "../../continuum/statistics.hpp"
 #include "../population.hpp"
 
 
@@ -56,129 +62,179 @@ static inline double _mm512_reduce_add_pd(__m512d const _a)
  *                DOI: 10.1103/PhysRev.94.511
  *
  * \tparam        odd    even (0, false) or odd (1, true) time step
+ * \tparam        save   save current macroscopic values to continuum (default = false)
  * \tparam        NX     simulation domain resolution in x-direction
  * \tparam        NY     simulation domain resolution in y-direction
  * \tparam        NZ     simulation domain resolution in z-direction
  * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam        PROP   propagation pattern (e.g. propagation::AA)
  * \tparam        T      floating data type used for simulation
- * \param[out]    con    continuum object holding macroscopic variables
+ * \tparam        STATS  Statistics<NX,NY,NZ,T>* or std::nullptr_t (deduced: nullptr removes the statistics)
+ * \tparam        MONITOR Monitor<NX,NY,NZ,T>* or std::nullptr_t (deduced: nullptr removes the diagnostics)
+ * \param[out]    con    continuum object holding macroscopic variables (only written if save)
  * \param[in,out] pop    population object holding microscopic variables
- * \param[in]     save   save current macroscopic values to disk (Boolean true/false)
  * \param[in]     p      relevant population (default = 0)
+ * \param[in]     block_begin   first loop block (default = 0)
+ * \param[in]     block_end     loop block after the last one (default = all blocks)
+ * \param[in,out] stats         statistics accumulated in this time step (default = nullptr: none,
+ *                              a null pointer of type STATS skips them at run time)
+ * \param[in,out] monitor       global diagnostics accumulated in this time step (default = nullptr:
+ *                              none, a null pointer of type MONITOR skips them at run time)
 */
-template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, typename T>
-void CollideStreamBGK_AVX512(Continuum<NX,NY,NZ,T>& con, Population<NX,NY,NZ,LT>& pop, bool const save = false, unsigned int const p = 0)
+template <bool odd, bool save = false, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class PROP, typename T,
+          class STATS = std::nullptr_t, class MONITOR = std::nullptr_t>
+void CollideStreamBGK_AVX512(Continuum<NX,NY,NZ,T>& con, Population<NX,NY,NZ,LT,1,PROP>& pop, unsigned int const p = 0,
+                             unsigned int const block_begin = 0, unsigned int const block_end = std::numeric_limits<unsigned int>::max(),
+                             [[maybe_unused]] STATS const stats = nullptr, [[maybe_unused]] MONITOR const monitor = nullptr)
 {
-    #pragma omp parallel for default(none) shared(con, pop) firstprivate(save,p) schedule(static,1)
-    for(unsigned int block = 0; block < pop.NUM_BLOCKS_; ++block)
+    /// optional features: passing nullptr removes them from the kernel at compile time
+    constexpr bool has_stats = (std::is_same<STATS, std::nullptr_t>::value == false);
+    static_assert((has_stats == false) || std::is_convertible<STATS, Statistics<NX,NY,NZ,T>*>::value, "Statistics do not match the continuum.");
+    constexpr bool has_monitor = (std::is_same<MONITOR, std::nullptr_t>::value == false);
+    static_assert((has_monitor == false) || std::is_convertible<MONITOR, Monitor<NX,NY,NZ,T>*>::value, "Monitor does not match the continuum.");
+
+    unsigned int const block_stop = std::min(block_end, pop.NUM_BLOCKS_);
+    unsigned int const      parts = parallel::ThreadsMax();
+    bool const            measure = pop.schedule_.measure_;
+
+    #pragma omp parallel for default(none) shared(con, pop) firstprivate(p,block_begin,block_stop,parts,measure,stats,monitor) schedule(static,1)
+    for(unsigned int part = 0; part < parts; ++part)
     {
-        unsigned int const z_start = pop.BLOCK_SIZE_ * (block / (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_));
-        unsigned int const   z_end = std::min(z_start + pop.BLOCK_SIZE_, NZ);
+        unsigned int const k_end = pop.schedule_.Begin(part + 1, parts, block_begin, block_stop);
 
-        for(unsigned int z = z_start; z < z_end; ++z)
+        for(unsigned int k = pop.schedule_.Begin(part, parts, block_begin, block_stop); k < k_end; ++k)
         {
-            unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
+            unsigned int const block = pop.order_.Block(k);
 
-            unsigned int const y_start = pop.BLOCK_SIZE_*((block % (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_)) / pop.NUM_BLOCKS_X_);
-            unsigned int const   y_end = std::min(y_start + pop.BLOCK_SIZE_, NY);
+            if (pop.flags_.IsSolidBlock(block) == true)
+            {
+                continue;
+            }
+
+            double const start = (measure == true) ? parallel::WallTime() : 0.0;
+
+            unsigned int const z_start = pop.BLOCK_SIZE_ * (block / (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_));
+            unsigned int const   z_end = std::min(z_start + pop.BLOCK_SIZE_, NZ);
 
-            for(unsigned int y = y_start; y < y_end; ++y)
+            for(unsigned int z = z_start; z < z_end; ++z)
             {
-                unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };
+                unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
 
-                unsigned int const x_start = pop.BLOCK_SIZE_*(block % pop.NUM_BLOCKS_X_);
-                unsigned int const   x_end = std::min(x_start + pop.BLOCK_SIZE_, NX);
+                unsigned int const y_start = pop.BLOCK_SIZE_*((block % (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_)) / pop.NUM_BLOCKS_X_);
+                unsigned int const   y_end = std::min(y_start + pop.BLOCK_SIZE_, NY);
 
-                for(unsigned int x = x_start; x < x_end; ++x)
+                for(unsigned int y = y_start; y < y_end; ++y)
                 {
-                    unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
+                    unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };
 
-                    /// load distributions
-                    alignas(CACHE_LINE) double f[LT::ND] = {0.0};
+                    unsigned int const x_start = pop.BLOCK_SIZE_*(block % pop.NUM_BLOCKS_X_);
+                    unsigned int const   x_end = std::min(x_start + pop.BLOCK_SIZE_, NX);
 
-                    #pragma GCC unroll (2)
-                    for(unsigned int n = 0; n <= 1; ++n)
+                    for(unsigned int x = pop.flags_.NextFluid(x_start, y, z, x_end); x < x_end; x = pop.flags_.NextFluid(x + 1, y, z, x_end))
                     {
-                        #pragma GCC unroll (16)
-                        for(unsigned int d = 0; d < LT::OFF; ++d)
+                        unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
+
+                        /// load distributions
+                        alignas(CACHE_LINE) double f[LT::ND] = {0.0};
+
+                        #pragma GCC unroll (2)
+                        for(unsigned int n = 0; n <= 1; ++n)
                         {
-                            f[n*LT::OFF + d] = pop.F_[pop. template AA_IndexRead<odd>(x_n,y_n,z_n,n,d,p)];
+                            #pragma GCC unroll (16)
+                            for(unsigned int d = 0; d < LT::OFF; ++d)
+                            {
+                                f[n*LT::OFF + d] = pop.F_[pop. template AA_IndexRead<odd>(x_n,y_n,z_n,n,d,p)];
+                            }
                         }
-                    }
 
-                    /// macroscopic values
-                    __m512d _rho = _mm512_setzero_pd();
-                    __m512d _u   = _mm512_setzero_pd();
-                    __m512d _v   = _mm512_setzero_pd();
-                    __m512d _w   = _mm512_setzero_pd();
+                        /// macroscopic values
+                        __m512d _rho = _mm512_setzero_pd();
+                        __m512d _u   = _mm512_setzero_pd();
+                        __m512d _v   = _mm512_setzero_pd();
+                        __m512d _w   = _mm512_setzero_pd();
 
-                    for (size_t i = 0; i < LT::ND; i += AVX512_REG_SIZE)
-                    {
-                        _rho = _mm512_add_pd(_mm512_load_pd(&f[i]), _rho);
-                        _u   = _mm512_fmadd_pd(_mm512_load_pd(&LT::DX[i]), _mm512_load_pd(&f[i]), _u);
-                        _v   = _mm512_fmadd_pd(_mm512_load_pd(&LT::DY[i]), _mm512_load_pd(&f[i]), _v);
-                        _w   = _mm512_fmadd_pd(_mm512_load_pd(&LT::DZ[i]), _mm512_load_pd(&f[i]), _w);
-                    }
+                        for (size_t i = 0; i < LT::ND; i += AVX512_REG_SIZE)
+                        {
+                            _rho = _mm512_add_pd(_mm512_load_pd(&f[i]), _rho);
+                            _u   = _mm512_fmadd_pd(_mm512_load_pd(&LT::DX[i]), _mm512_load_pd(&f[i]), _u);
+                            _v   = _mm512_fmadd_pd(_mm512_load_pd(&LT::DY[i]), _mm512_load_pd(&f[i]), _v);
+                            _w   = _mm512_fmadd_pd(_mm512_load_pd(&LT::DZ[i]), _mm512_load_pd(&f[i]), _w);
+                        }
 
-                    double const rho = _mm512_reduce_add_pd(_rho);
-                    double const u   = _mm512_reduce_add_pd(_u)/rho;
-                    double const v   = _mm512_reduce_add_pd(_v)/rho;
-                    double const w   = _mm512_reduce_add_pd(_w)/rho;
+                        double const rho = _mm512_reduce_add_pd(_rho);
+                        double const u   = _mm512_reduce_add_pd(_u)/rho;
+                        double const v   = _mm512_reduce_add_pd(_v)/rho;
+                        double const w   = _mm512_reduce_add_pd(_w)/rho;
 
-                    if (save == true)
-                    {
-                        con(x, y, z, 0) = rho;
-                        con(x, y, z, 1) = u;
-                        con(x, y, z, 2) = v;
-                        con(x, y, z, 3) = w;
-                    }
+                        if constexpr (save == true)
+                        {
+                            con(x, y, z, 0) = rho;
+                            con(x, y, z, 1) = u;
+                            con(x, y, z, 2) = v;
+                            con(x, y, z, 3) = w;
+                        }
+
+                        if constexpr (has_stats == true)
+                        {
+                            if (stats != nullptr)
+                            {
+                                stats->Accumulate(x, y, z, rho, u, v, w);
+                            }
+                        }
 
-                    /// equilibrium distributions
-                    alignas(CACHE_LINE) double feq[LT::ND] = {0.0};
+                        if constexpr (has_monitor == true)
+                        {
+                            if (monitor != nullptr)
+                            {
+                                monitor->Accumulate(part, x, y, z, rho, u, v, w);
+                            }
+                        }
 
-                    __m512d const _uu = _mm512_set1_pd(-1.0/(2.0*LT::CS*LT::CS)*(u*u + v*v + w*w));
-                    _rho = _mm512_set1_pd(rho);
-                    _u   = _mm512_set1_pd(u);
-                    _v   = _mm512_set1_pd(v);
-                    _w   = _mm512_set1_pd(w);
+                        /// equilibrium distributions
+                        alignas(CACHE_LINE) double feq[LT::ND] = {0.0};
 
-                    for (size_t i = 0; i < LT::ND; i += AVX512_REG_SIZE)
-                    {
-                        __m512d _cu = _mm512_mul_pd(_mm512_load_pd(&LT::DX[i]), _u);
-                        _cu = _mm512_fmadd_pd(_mm512_load_pd(&LT::DY[i]), _v, _cu);
-                        _cu = _mm512_fmadd_pd(_mm512_load_pd(&LT::DZ[i]), _w, _cu);
-                        _cu = _mm512_mul_pd(_cu, _mm512_set1_pd(1.0/(LT::CS*LT::CS)));
+                        __m512d const _uu = _mm512_set1_pd(-1.0/(2.0*LT::CS*LT::CS)*(u*u + v*v + w*w));
+                        _rho = _mm512_set1_pd(rho);
+                        _u   = _mm512_set1_pd(u);
+                        _v   = _mm512_set1_pd(v);
+                        _w   = _mm512_set1_pd(w);
 
-                        __m512d _res = _mm512_fmadd_pd(_mm512_set1_pd(0.5), _cu, _mm512_set1_pd(1.0));
-                        _res = _mm512_fmadd_pd(_cu, _res, _uu);
+                        for (size_t i = 0; i < LT::ND; i += AVX512_REG_SIZE)
+                        {
+                            __m512d _cu = _mm512_mul_pd(_mm512_load_pd(&LT::DX[i]), _u);
+                            _cu = _mm512_fmadd_pd(_mm512_load_pd(&LT::DY[i]), _v, _cu);
+                            _cu = _mm512_fmadd_pd(_mm512_load_pd(&LT::DZ[i]), _w, _cu);
+                            _cu = _mm512_mul_pd(_cu, _mm512_set1_pd(1.0/(LT::CS*LT::CS)));
 
-                        _res = _mm512_fmadd_pd(_res, _rho, _rho);
-                        _res = _mm512_mul_pd(_mm512_load_pd(&LT::W[i]), _res);
-                        _mm512_store_pd(&feq[i], _res);
-                    }
+                            __m512d _res = _mm512_fmadd_pd(_mm512_set1_pd(0.5), _cu, _mm512_set1_pd(1.0));
+                            _res = _mm512_fmadd_pd(_cu, _res, _uu);
 
-                    /// collision
-                    for (size_t i = 0; i < LT::ND; i += AVX512_REG_SIZE)
-                    {
-                        __m512d _res = _mm512_sub_pd(_mm512_load_pd(&feq[i]), _mm512_load_pd(&f[i]));
-                        _res = _mm512_fmadd_pd(_mm512_set1_pd(pop.OMEGA_), _res, _mm512_load_pd(&f[i]));
-                        _mm512_store_pd(&f[i], _mm512_mul_pd(_mm512_load_pd(&LT::MASK[i]), _res));
-                    }
+                            _res = _mm512_fmadd_pd(_res, _rho, _rho);
+                            _res = _mm512_mul_pd(_mm512_load_pd(&LT::W[i]), _res);
+                            _mm512_store_pd(&feq[i], _res);
+                        }
 
-                    /// streaming
-                    #pragma GCC unroll (2)
-                    for(unsigned int n = 0; n <= 1; ++n)
-                    {
-                        #pragma GCC unroll (16)
-                        for(unsigned int d = 0; d < LT::OFF; ++d)
+                        /// collision
+                        for (size_t i = 0; i < LT::ND; i += AVX512_REG_SIZE)
                         {
-                            size_t const curr = n*LT::OFF + d;
-                            pop.F_[pop. template AA_IndexWrite<odd>(x_n,y_n,z_n,n,d,p)] = f[curr];
+                            __m512d _res = _mm512_sub_pd(_mm512_load_pd(&feq[i]), _mm512_load_pd(&f[i]));
+                            _res = _mm512_fmadd_pd(_mm512_set1_pd(pop.OMEGA_), _res, _mm512_load_pd(&f[i]));
+                            _mm512_store_pd(&f[i], _mm512_mul_pd(_mm512_load_pd(&LT::MASK[i]), _res));
                         }
+
+                        /// streaming
+                        pop. template WriteCell<odd>(x_n,y_n,z_n,f,p);
                     }
                 }
             }
+
+            if (measure == true)
+            {
+                pop.schedule_.Record(block, parallel::WallTime() - start);
+            }
         }
+
+        pop.Fence();
     }
 }
 
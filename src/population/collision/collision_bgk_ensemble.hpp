@@ -0,0 +1,185 @@
+#ifndef COLLISION_BGK_ENSEMBLE_HPP_INCLUDED
+#define COLLISION_BGK_ENSEMBLE_HPP_INCLUDED
+
+/**
+ * \file     collision_bgk_ensemble.hpp
+ * \mainpage BGK collision operator for an ensemble of simulations on the same domain
+ *
+ * \note     The NPOP populations of a lattice are independent members of an ensemble (e.g.
+ *           different Reynolds numbers or inflow conditions for uncertainty quantification). The
+ *           populations of a cell are interleaved per lattice velocity, so the members are
+ *           processed as SIMD lanes: the indices are evaluated once per lattice velocity for all
+ *           members and the loads and stores are contiguous. The cell is written by WriteCell
+ *           (streamed with non-temporal stores by propagation patterns that support them). Every
+ *           member has its own relaxation rate (see Ensemble), boundary values are set per member
+ *           by the boundary conditions with a relevant population p and the macroscopic values of a
+ *           member are obtained with ComputeMacroscopic.
+*/
+
+#include <algorithm>
+#include <limits>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../../general/memory_alignment.hpp"
+#include "../../general/parallelism.hpp"
+#include "../ensemble.hpp"
+#include "../population.hpp"
+
+
+/**\fn            CollideStreamBGK_Ensemble
+ * \brief         BGK collision operator for all members of an ensemble stored in the populations of
+ *                a lattice
+ *
+ * \tparam        odd           even (0, false) or odd (1, true) time step
+ * \tparam        NX            simulation domain resolution in x-direction
+ * \tparam        NY            simulation domain resolution in y-direction
+ * \tparam        NZ            simulation domain resolution in z-direction
+ * \tparam        LT            static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP          number of ensemble members
+ * \tparam        PROP          propagation pattern (e.g. propagation::AA)
+ * \param[in,out] pop           population object holding the microscopic variables of all members
+ * \param[in]     ensemble      physical parameters of every member
+ * \param[in]     block_begin   first loop block (default = 0)
+ * \param[in]     block_end     loop block after the last one (default = all blocks)
+*/
+template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP>
+void CollideStreamBGK_Ensemble(Population<NX,NY,NZ,LT,NPOP,PROP>& pop,
+                               Ensemble<LT,NPOP> const& ensemble,
+                               unsigned int const block_begin = 0, unsigned int const block_end = std::numeric_limits<unsigned int>::max())
+{
+    typedef typename Population<NX,NY,NZ,LT,NPOP,PROP>::T T;
+
+    unsigned int const block_stop = std::min(block_end, pop.NUM_BLOCKS_);
+    unsigned int const      parts = parallel::ThreadsMax();
+    bool const            measure = pop.schedule_.measure_;
+
+    #pragma omp parallel for default(none) shared(pop, ensemble) firstprivate(block_begin,block_stop,parts,measure) schedule(static,1)
+    for(unsigned int part = 0; part < parts; ++part)
+    {
+        unsigned int const k_end = pop.schedule_.Begin(part + 1, parts, block_begin, block_stop);
+
+        for(unsigned int k = pop.schedule_.Begin(part, parts, block_begin, block_stop); k < k_end; ++k)
+        {
+            unsigned int const block = pop.order_.Block(k);
+
+            if (pop.flags_.IsSolidBlock(block) == true)
+            {
+                continue;
+            }
+
+            double const start = (measure == true) ? parallel::WallTime() : 0.0;
+
+            unsigned int const z_start = pop.BLOCK_SIZE_ * (block / (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_));
+            unsigned int const   z_end = std::min(z_start + pop.BLOCK_SIZE_, NZ);
+
+            for(unsigned int z = z_start; z < z_end; ++z)
+            {
+                unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
+
+                unsigned int const y_start = pop.BLOCK_SIZE_*((block % (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_)) / pop.NUM_BLOCKS_X_);
+                unsigned int const   y_end = std::min(y_start + pop.BLOCK_SIZE_, NY);
+
+                for(unsigned int y = y_start; y < y_end; ++y)
+                {
+                    unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };
+
+                    unsigned int const x_start = pop.BLOCK_SIZE_*(block % pop.NUM_BLOCKS_X_);
+                    unsigned int const   x_end = std::min(x_start + pop.BLOCK_SIZE_, NX);
+
+                    for(unsigned int x = pop.flags_.NextFluid(x_start, y, z, x_end); x < x_end; x = pop.flags_.NextFluid(x + 1, y, z, x_end))
+                    {
+                        unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
+
+                        /// load distributions: one index per lattice velocity for all members
+                        alignas(CACHE_LINE) T f[LT::ND][NPOP] = {};
+
+                        #pragma GCC unroll (2)
+                        for(unsigned int n = 0; n <= 1; ++n)
+                        {
+                            #pragma GCC unroll (16)
+                            for(unsigned int d = n; d < LT::HSPEED; ++d)
+                            {
+                                T const* const src = pop.F_ + pop. template AA_IndexRead<odd>(x_n,y_n,z_n,n,d,0);
+
+                                #pragma omp simd
+                                for(unsigned int p = 0; p < NPOP; ++p)
+                                {
+                                    f[n*LT::OFF + d][p] = src[p];
+                                }
+                            }
+                        }
+
+                        /// macroscopic values
+                        alignas(CACHE_LINE) T rho[NPOP] = {0.0};
+                        alignas(CACHE_LINE) T u[NPOP]   = {0.0};
+                        alignas(CACHE_LINE) T v[NPOP]   = {0.0};
+                        alignas(CACHE_LINE) T w[NPOP]   = {0.0};
+
+                        #pragma GCC unroll (2)
+                        for(unsigned int n = 0; n <= 1; ++n)
+                        {
+                            #pragma GCC unroll (16)
+                            for(unsigned int d = n; d < LT::HSPEED; ++d)
+                            {
+                                unsigned int const curr = n*LT::OFF + d;
+
+                                #pragma omp simd
+                                for(unsigned int p = 0; p < NPOP; ++p)
+                                {
+                                    rho[p] += f[curr][p];
+                                    u[p]   += f[curr][p]*LT::DX[curr];
+                                    v[p]   += f[curr][p]*LT::DY[curr];
+                                    w[p]   += f[curr][p]*LT::DZ[curr];
+                                }
+                            }
+                        }
+
+                        alignas(CACHE_LINE) T uu[NPOP];
+
+                        #pragma omp simd
+                        for(unsigned int p = 0; p < NPOP; ++p)
+                        {
+                            u[p]  /= rho[p];
+                            v[p]  /= rho[p];
+                            w[p]  /= rho[p];
+                            uu[p]  = - 1.0/(2.0*LT::CS*LT::CS)*(u[p]*u[p] + v[p]*v[p] + w[p]*w[p]);
+                        }
+
+                        /// collision
+                        #pragma GCC unroll (2)
+                        for(unsigned int n = 0; n <= 1; ++n)
+                        {
+                            #pragma GCC unroll (16)
+                            for(unsigned int d = n; d < LT::HSPEED; ++d)
+                            {
+                                unsigned int const curr = n*LT::OFF + d;
+
+                                #pragma omp simd
+                                for(unsigned int p = 0; p < NPOP; ++p)
+                                {
+                                    T const cu  = 1.0/(LT::CS*LT::CS)*(u[p]*LT::DX[curr] + v[p]*LT::DY[curr] + w[p]*LT::DZ[curr]);
+                                    T const feq = LT::W[curr]*(rho[p] + rho[p]*(cu*(1.0 + 0.5*cu) + uu[p]));
+                                    f[curr][p] += ensemble.OMEGA_[p]*(feq - f[curr][p]);
+                                }
+                            }
+                        }
+
+                        /// streaming
+                        pop. template WriteCell<odd>(x_n,y_n,z_n,f);
+                    }
+                }
+            }
+
+            if (measure == true)
+            {
+                pop.schedule_.Record(block, parallel::WallTime() - start);
+            }
+        }
+
+        pop.Fence();
+    }
+}
+
+#endif // COLLISION_BGK_ENSEMBLE_HPP_INCLUDED
@@ -0,0 +1,143 @@
+#ifndef COLLISION_BGK_ENSEMBLE_UNIT_TEST_HPP_INCLUDED
+#define COLLISION_BGK_ENSEMBLE_UNIT_TEST_HPP_INCLUDED
+
+/**
+ * \file     collision_bgk_ensemble_unit_test.hpp
+ * \mainpage Unit test for the ensemble BGK kernel: every member has to evolve like a separate
+ *           single-population BGK simulation
+*/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+
+#include "../../continuum/continuum.hpp"
+#include "../../lattice/D3Q19.hpp"
+#include "../ensemble.hpp"
+#include "../initialisation.hpp"
+#include "../population.hpp"
+#include "../population_propagation.hpp"
+#include "collision_bgk.hpp"
+#include "collision_bgk_ensemble.hpp"
+
+
+/**\fn        CompareEnsemble
+ * \brief     Run an ensemble of decaying shear waves with different Reynolds numbers and amplitudes
+ *            side by side with one single-population BGK simulation per member and compare all
+ *            populations (padding excluded) of all lattices after the last time step
+ *
+ * \tparam    PROP   propagation pattern (e.g. propagation::AA)
+ * \param[in] name   name of the propagation pattern for the error message
+ * \return    EXIT_SUCCESS if all members agree with the single-population runs, else EXIT_FAILURE
+*/
+template <class PROP>
+int CompareEnsemble(char const* const name)
+{
+    constexpr unsigned int   NX = 16;
+    constexpr unsigned int   NY = 12;
+    constexpr unsigned int   NZ = 8;
+    constexpr unsigned int NPOP = 4;
+    constexpr unsigned int   NT = 20;
+    constexpr unsigned int    L = NY;
+    constexpr double         PI = 3.14159265358979323846;
+    constexpr double  TOLERANCE = 1e-12;
+    typedef lattice::D3Q19<double> DdQq;
+    typedef Population<NX,NY,NZ,DdQq,1,PROP> Single;
+
+    std::array<double,NPOP> const Re = {10.0, 50.0, 100.0, 1000.0};
+    std::array<double,NPOP> const U  = {0.01, 0.02, 0.05, 0.08};
+
+    Ensemble<DdQq,NPOP> const Members(Re, U, L);
+    Population<NX,NY,NZ,DdQq,NPOP,PROP> Micro(Re[0], U[0], L);
+    std::unique_ptr<Single> Reference[NPOP];
+    Continuum<NX,NY,NZ,double> Macro;
+
+    /// three-dimensional shear waves with a density perturbation, scaled with the velocity of the member
+    for(unsigned int p = 0; p < NPOP; ++p)
+    {
+        for(unsigned int z = 0; z < NZ; ++z)
+        {
+            for(unsigned int y = 0; y < NY; ++y)
+            {
+                for(unsigned int x = 0; x < NX; ++x)
+                {
+                    Macro(x, y, z, 0) = 1.0 + 0.01*std::cos(2.0*PI*x/NX)*std::sin(2.0*PI*z/NZ);
+                    Macro(x, y, z, 1) = U[p]*std::sin(2.0*PI*y/NY);
+                    Macro(x, y, z, 2) = U[p]*std::sin(2.0*PI*z/NZ);
+                    Macro(x, y, z, 3) = U[p]*std::sin(2.0*PI*x/NX);
+                }
+            }
+        }
+
+        Reference[p] = std::make_unique<Single>(Re[p], U[p], L);
+        InitLattice<false>(Macro, *Reference[p]);
+        InitLattice<false>(Macro, Micro, p);
+    }
+
+    for(unsigned int i = 0; i < NT; i += 2)
+    {
+        CollideStreamBGK_Ensemble<false>(Micro, Members);
+        CollideStreamBGK_Ensemble<true>(Micro, Members);
+
+        for(unsigned int p = 0; p < NPOP; ++p)
+        {
+            CollideStreamBGK<false>(Macro, *Reference[p]);
+            CollideStreamBGK<true>(Macro, *Reference[p]);
+        }
+    }
+
+    double error = 0.0;
+    for(unsigned int p = 0; p < NPOP; ++p)
+    {
+        for(unsigned int lattice = 0; lattice < PROP::LATTICES; ++lattice)
+        {
+            for(unsigned int z = 0; z < NZ; ++z)
+            {
+                for(unsigned int y = 0; y < NY; ++y)
+                {
+                    for(unsigned int x = 0; x < NX; ++x)
+                    {
+                        for(unsigned int n = 0; n <= 1; ++n)
+                        {
+                            for(unsigned int d = n; d < DdQq::HSPEED; ++d)
+                            {
+                                double const f_ensemble  = Micro.F_[lattice*Micro.LATTICE_SIZE_ + Micro.SpatialToLinear(x, y, z, n, d, p)];
+                                double const f_reference = Reference[p]->F_[lattice*Single::LATTICE_SIZE_ + Reference[p]->SpatialToLinear(x, y, z, n, d)];
+                                error = std::max(error, std::abs(f_ensemble - f_reference)/std::abs(f_reference));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if ((std::isfinite(error) == false) || (error > TOLERANCE))
+    {
+        std::cerr << "Error: Ensemble members differ from the single-population runs (" << name
+                  << ", maximum relative difference " << error << ")." << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**\fn     UnitTestEnsemble
+ * \brief  Compare the members of an ensemble to single-population BGK runs for the A-A pattern and
+ *         for the two-lattice pattern whose cells are streamed with non-temporal stores
+ *
+ * \return EXIT_SUCCESS if the test passed, else EXIT_FAILURE
+*/
+inline int UnitTestEnsemble()
+{
+    int result = CompareEnsemble<propagation::AA>("A-A pattern");
+    if (CompareEnsemble<propagation::AB>("A-B pattern") != EXIT_SUCCESS)
+    {
+        result = EXIT_FAILURE;
+    }
+    return result;
+}
+
+#endif // COLLISION_BGK_ENSEMBLE_UNIT_TEST_HPP_INCLUDED
@@ -0,0 +1,47 @@
+#ifndef ENSEMBLE_HPP_INCLUDED
+#define ENSEMBLE_HPP_INCLUDED
+
+/**
+ * \file     ensemble.hpp
+ * \mainpage Physical parameters of the members of an ensemble stored in the populations of a lattice
+*/
+
+#include <array>
+#include <type_traits>
+
+
+/**\class  Ensemble
+ * \brief  Viscosity, relaxation time and collision frequency of every ensemble member
+ *
+ * \tparam LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam NPOP   number of ensemble members (populations of the lattice)
+*/
+template <class LT, unsigned int NPOP>
+class Ensemble
+{
+    public:
+        /// import current lattice floating data type
+        typedef typename std::remove_const<decltype(LT::CS)>::type T;
+
+        T NU_[NPOP];      ///< kinematic simulation viscosity
+        T TAU_[NPOP];     ///< laminar relaxation time
+        T OMEGA_[NPOP];   ///< collision frequency
+
+        /**\brief     Class constructor
+         *
+         * \param[in] Re   simulation Reynolds number of every member
+         * \param[in] U    characteristic velocity of every member in lattice units
+         * \param[in] L    characteristic length of the simulation in lattice units
+        */
+        Ensemble(std::array<T,NPOP> const& Re, std::array<T,NPOP> const& U, unsigned int const L)
+        {
+            for(unsigned int p = 0; p < NPOP; ++p)
+            {
+                NU_[p]    = U[p]*static_cast<T>(L) / Re[p];
+                TAU_[p]   = NU_[p]/(LT::CS*LT::CS) + 1.0/2.0;
+                OMEGA_[p] = 1.0/TAU_[p];
+            }
+        }
+};
+
+#endif // ENSEMBLE_HPP_INCLUDED
@@ -13,6 +13,7 @@
 #endif
 
 #include "../continuum/continuum.hpp"
+#include "../general/parallelism.hpp"
 #include "population.hpp"
 
 
@@ -24,54 +25,168 @@
  * \tparam     NY    simulation domain resolution in y-direction
  * \tparam     NZ    simulation domain resolution in z-direction
  * \tparam     LT    static lattice::DdQq class containing discretisation parameters
+ * \tparam     NPOP  number of populations stored side by side in the lattice
+ * \tparam     PROP  propagation pattern (e.g. propagation::AA)
  * \tparam     T     floating data type used for simulation
  * \param[in]  con   continuum object holding macroscopic variables
  * \param[out] pop   population object holding microscopic variables
  * \param[in]  p     relevant population (default = 0)
 */
-template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, typename T>
-void InitLattice(Continuum<NX,NY,NZ,T> const& con, Population<NX,NY,NZ,LT>& pop, unsigned int const p = 0)
+template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP, typename T>
+void InitLattice(Continuum<NX,NY,NZ,T> const& con, Population<NX,NY,NZ,LT,NPOP,PROP>& pop, unsigned int const p = 0)
 {
-    #pragma omp parallel for default(none) shared(con, pop) firstprivate(p) schedule(static,1)
-    for(unsigned int block = 0; block < pop.NUM_BLOCKS_; ++block)
+    unsigned int const parts = parallel::ThreadsMax();
+
+    #pragma omp parallel for default(none) shared(con, pop) firstprivate(p,parts) schedule(static,1)
+    for(unsigned int part = 0; part < parts; ++part)
     {
-        unsigned int const z_start = pop.BLOCK_SIZE_ * (block / (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_));
-        unsigned int const   z_end = std::min(z_start + pop.BLOCK_SIZE_, NZ);
+        unsigned int const k_end = pop.schedule_.Begin(part + 1, parts, 0, pop.NUM_BLOCKS_);
 
-        for(unsigned int z = z_start; z < z_end; ++z)
+        for(unsigned int k = pop.schedule_.Begin(part, parts, 0, pop.NUM_BLOCKS_); k < k_end; ++k)
         {
-            unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
+            unsigned int const block = pop.order_.Block(k);
 
-            unsigned int const y_start = pop.BLOCK_SIZE_*((block % (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_)) / pop.NUM_BLOCKS_X_);
-            unsigned int const   y_end = std::min(y_start + pop.BLOCK_SIZE_, NY);
+            unsigned int const z_start = pop.BLOCK_SIZE_ * (block / (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_));
+            unsigned int const   z_end = std::min(z_start + pop.BLOCK_SIZE_, NZ);
 
-            for(unsigned int y = y_start; y < y_end; ++y)
+            for(unsigned int z = z_start; z < z_end; ++z)
             {
-                unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };
+                unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
 
-                unsigned int const x_start = pop.BLOCK_SIZE_*(block % pop.NUM_BLOCKS_X_);
-                unsigned int const   x_end = std::min(x_start + pop.BLOCK_SIZE_, NX);
+                unsigned int const y_start = pop.BLOCK_SIZE_*((block % (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_)) / pop.NUM_BLOCKS_X_);
+                unsigned int const   y_end = std::min(y_start + pop.BLOCK_SIZE_, NY);
 
-                for(unsigned int x = x_start; x < x_end; ++x)
+                for(unsigned int y = y_start; y < y_end; ++y)
                 {
-                    unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
+                    unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };
+
+                    unsigned int const x_start = pop.BLOCK_SIZE_*(block % pop.NUM_BLOCKS_X_);
+                    unsigned int const   x_end = std::min(x_start + pop.BLOCK_SIZE_, NX);
+
+                    for(unsigned int x = x_start; x < x_end; ++x)
+                    {
+                        unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
 
-                    T const rho = con(x, y, z, 0);
-                    T const u   = con(x, y, z, 1);
-                    T const v   = con(x, y, z, 2);
-                    T const w   = con(x, y, z, 3);
+                        T const rho = con(x, y, z, 0);
+                        T const u   = con(x, y, z, 1);
+                        T const v   = con(x, y, z, 2);
+                        T const w   = con(x, y, z, 3);
 
-                    T const uu = - 1.0/(2.0*LT::CS*LT::CS)*(u*u + v*v + w*w);
+                        T const uu = - 1.0/(2.0*LT::CS*LT::CS)*(u*u + v*v + w*w);
 
-                    #pragma GCC unroll (2)
-                    for(unsigned int n = 0; n <= 1; ++n)
+                        #pragma GCC unroll (2)
+                        for(unsigned int n = 0; n <= 1; ++n)
+                        {
+                            #pragma GCC unroll (16)
+                            for(unsigned int d = n; d < LT::OFF; ++d)
+                            {
+                                unsigned int const curr = n*LT::OFF + d;
+                                T const cu = 1.0/(LT::CS*LT::CS)*(u*LT::DX[curr] + v*LT::DY[curr] + w*LT::DZ[curr]);
+                                pop.F_[pop. template AA_IndexRead<odd>(x_n,y_n,z_n,n,d,p)] = LT::W[curr]*(rho + rho*(cu*(1.0 + 0.5*cu) + uu));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**\fn         InitLatticeNonEquilibrium
+ * \brief      Initialise microscopic distributions from continuum values including a finite
+ *             difference estimate of the non-equilibrium part (warm start of a simulation)
+ * \note       The equilibrium alone carries no shear stresses and causes a long transient when
+ *             restarting from macroscopic values. From the Chapman-Enskog expansion the leading
+ *             non-equilibrium part is f_neq = - w rho tau / cs^2 Q:grad(u) with Q = c c - cs^2 I,
+ *             where the velocity gradient is estimated by central differences (periodic neighbours).
+ *             The molecular relaxation time is used also for turbulence models.
+ *
+ * \tparam     odd   even (0, false) or odd (1, true) time step
+ * \tparam     NX    simulation domain resolution in x-direction
+ * \tparam     NY    simulation domain resolution in y-direction
+ * \tparam     NZ    simulation domain resolution in z-direction
+ * \tparam     LT    static lattice::DdQq class containing discretisation parameters
+ * \tparam     PROP  propagation pattern (e.g. propagation::AA)
+ * \tparam     T     floating data type used for simulation
+ * \param[in]  con   continuum object holding macroscopic variables
+ * \param[out] pop   population object holding microscopic variables
+ * \param[in]  p     relevant population (default = 0)
+*/
+template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class PROP, typename T>
+void InitLatticeNonEquilibrium(Continuum<NX,NY,NZ,T> const& con, Population<NX,NY,NZ,LT,1,PROP>& pop, unsigned int const p = 0)
+{
+    unsigned int const parts = parallel::ThreadsMax();
+
+    #pragma omp parallel for default(none) shared(con, pop) firstprivate(p,parts) schedule(static,1)
+    for(unsigned int part = 0; part < parts; ++part)
+    {
+        unsigned int const k_end = pop.schedule_.Begin(part + 1, parts, 0, pop.NUM_BLOCKS_);
+
+        for(unsigned int k = pop.schedule_.Begin(part, parts, 0, pop.NUM_BLOCKS_); k < k_end; ++k)
+        {
+            unsigned int const block = pop.order_.Block(k);
+
+            unsigned int const z_start = pop.BLOCK_SIZE_ * (block / (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_));
+            unsigned int const   z_end = std::min(z_start + pop.BLOCK_SIZE_, NZ);
+
+            for(unsigned int z = z_start; z < z_end; ++z)
+            {
+                unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
+
+                unsigned int const y_start = pop.BLOCK_SIZE_*((block % (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_)) / pop.NUM_BLOCKS_X_);
+                unsigned int const   y_end = std::min(y_start + pop.BLOCK_SIZE_, NY);
+
+                for(unsigned int y = y_start; y < y_end; ++y)
+                {
+                    unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };
+
+                    unsigned int const x_start = pop.BLOCK_SIZE_*(block % pop.NUM_BLOCKS_X_);
+                    unsigned int const   x_end = std::min(x_start + pop.BLOCK_SIZE_, NX);
+
+                    for(unsigned int x = x_start; x < x_end; ++x)
                     {
-                        #pragma GCC unroll (16)
-                        for(unsigned int d = n; d < LT::OFF; ++d)
+                        unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
+
+                        T const rho = con(x, y, z, 0);
+                        T const u   = con(x, y, z, 1);
+                        T const v   = con(x, y, z, 2);
+                        T const w   = con(x, y, z, 3);
+
+                        T const uu = - 1.0/(2.0*LT::CS*LT::CS)*(u*u + v*v + w*w);
+
+                        /// velocity gradient du[a][b] = d u_b / d x_a by central differences
+                        T du[3][3];
+                        #pragma GCC unroll (3)
+                        for(unsigned int b = 0; b < 3; ++b)
                         {
-                            unsigned int const curr = n*LT::OFF + d;
-                            T const cu = 1.0/(LT::CS*LT::CS)*(u*LT::DX[curr] + v*LT::DY[curr] + w*LT::DZ[curr]);
-                            pop.F_[pop. template AA_IndexRead<odd>(x_n,y_n,z_n,n,d,p)] = LT::W[curr]*(rho + rho*(cu*(1.0 + 0.5*cu) + uu));
+                            du[0][b] = 0.5*(con(x_n[2], y, z, 1 + b) - con(x_n[0], y, z, 1 + b));
+                            du[1][b] = 0.5*(con(x, y_n[2], z, 1 + b) - con(x, y_n[0], z, 1 + b));
+                            du[2][b] = 0.5*(con(x, y, z_n[2], 1 + b) - con(x, y, z_n[0], 1 + b));
+                        }
+                        T const divergence = du[0][0] + du[1][1] + du[2][2];
+                        T const factor     = - rho*pop.TAU_/(LT::CS*LT::CS);
+
+                        #pragma GCC unroll (2)
+                        for(unsigned int n = 0; n <= 1; ++n)
+                        {
+                            #pragma GCC unroll (16)
+                            for(unsigned int d = n; d < LT::OFF; ++d)
+                            {
+                                unsigned int const curr = n*LT::OFF + d;
+                                T const c[3] = { LT::DX[curr], LT::DY[curr], LT::DZ[curr] };
+
+                                T cc = 0.0;
+                                #pragma GCC unroll (3)
+                                for(unsigned int a = 0; a < 3; ++a)
+                                {
+                                    cc += c[a]*(c[0]*du[a][0] + c[1]*du[a][1] + c[2]*du[a][2]);
+                                }
+
+                                T const cu = 1.0/(LT::CS*LT::CS)*(u*c[0] + v*c[1] + w*c[2]);
+                                T const feq  = LT::W[curr]*(rho + rho*(cu*(1.0 + 0.5*cu) + uu));
+                                T const fneq = LT::W[curr]*factor*(cc - LT::CS*LT::CS*divergence);
+                                pop.F_[pop. template AA_IndexRead<odd>(x_n,y_n,z_n,n,d,p)] = feq + fneq;
+                            }
                         }
                     }
                 }
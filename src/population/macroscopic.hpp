@@ -0,0 +1,131 @@
+#ifndef POPULATION_MACROSCOPIC_HPP_INCLUDED
+#define POPULATION_MACROSCOPIC_HPP_INCLUDED
+
+/**
+ * \file     macroscopic.hpp
+ * \mainpage Reconstruction of the macroscopic values of a continuum from a population
+ *
+ * \note     Saving the macroscopic values inside the collide-stream kernels costs four stores per cell
+ *           in every time step. Instead the continuum can be filled by a separate sweep only in those
+ *           time steps where it is actually required (export, diagnostics).
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../continuum/continuum.hpp"
+#include "../general/parallelism.hpp"
+#include "population.hpp"
+
+
+/**\fn         ComputeMacroscopic
+ * \brief      Compute density and velocities of all cells from the populations. Has to be called
+ *             between two time steps and yields the same values as a kernel of the following time step
+ *             that saves the macroscopic values (without boundary conditions applied in between). If
+ *             the kernel adds a force density the same force has to be passed: with Guo forcing the
+ *             velocity is shifted by half the force.
+ *
+ * \tparam     odd   parity of the following time step: even (0, false) or odd (1, true)
+ * \tparam     NX    simulation domain resolution in x-direction
+ * \tparam     NY    simulation domain resolution in y-direction
+ * \tparam     NZ    simulation domain resolution in z-direction
+ * \tparam     LT    static lattice::DdQq class containing discretisation parameters
+ * \tparam     NPOP  number of populations stored side by side in the lattice
+ * \tparam     PROP  propagation pattern (e.g. propagation::AA)
+ * \tparam     T     floating data type used for simulation
+ * \tparam     FORCE T const* or std::nullptr_t (deduced: nullptr removes the forcing)
+ * \param[out] con   continuum object holding macroscopic variables
+ * \param[in]  pop   population object holding microscopic variables
+ * \param[in]  p     relevant population (default = 0)
+ * \param[in]  force external force density [Fx,Fy,Fz] per cell of the following time step
+ *                   (default = nullptr: none)
+*/
+template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP, typename T,
+          class FORCE = std::nullptr_t>
+void ComputeMacroscopic(Continuum<NX,NY,NZ,T>& con, Population<NX,NY,NZ,LT,NPOP,PROP> const& pop, unsigned int const p = 0,
+                        [[maybe_unused]] FORCE const force = nullptr)
+{
+    constexpr bool has_force = (std::is_same<FORCE, std::nullptr_t>::value == false);
+    static_assert((has_force == false) || std::is_convertible<FORCE, T const*>::value, "Force density does not match the floating data type.");
+
+    unsigned int const parts = parallel::ThreadsMax();
+
+    #pragma omp parallel for default(none) shared(con, pop) firstprivate(p,parts,force) schedule(static,1)
+    for(unsigned int part = 0; part < parts; ++part)
+    {
+        unsigned int const k_end = pop.schedule_.Begin(part + 1, parts, 0, pop.NUM_BLOCKS_);
+
+        for(unsigned int k = pop.schedule_.Begin(part, parts, 0, pop.NUM_BLOCKS_); k < k_end; ++k)
+        {
+            unsigned int const block = pop.order_.Block(k);
+
+            if (pop.flags_.IsSolidBlock(block) == true)
+            {
+                continue;
+            }
+
+            unsigned int const z_start = pop.BLOCK_SIZE_ * (block / (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_));
+            unsigned int const   z_end = std::min(z_start + pop.BLOCK_SIZE_, NZ);
+
+            for(unsigned int z = z_start; z < z_end; ++z)
+            {
+                unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
+
+                unsigned int const y_start = pop.BLOCK_SIZE_*((block % (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_)) / pop.NUM_BLOCKS_X_);
+                unsigned int const   y_end = std::min(y_start + pop.BLOCK_SIZE_, NY);
+
+                for(unsigned int y = y_start; y < y_end; ++y)
+                {
+                    unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };
+
+                    unsigned int const x_start = pop.BLOCK_SIZE_*(block % pop.NUM_BLOCKS_X_);
+                    unsigned int const   x_end = std::min(x_start + pop.BLOCK_SIZE_, NX);
+
+                    for(unsigned int x = pop.flags_.NextFluid(x_start, y, z, x_end); x < x_end; x = pop.flags_.NextFluid(x + 1, y, z, x_end))
+                    {
+                        unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
+
+                        T rho = 0.0;
+                        T u   = 0.0;
+                        T v   = 0.0;
+                        T w   = 0.0;
+
+                        #pragma GCC unroll (2)
+                        for(unsigned int n = 0; n <= 1; ++n)
+                        {
+                            #pragma GCC unroll (16)
+                            for(unsigned int d = n; d < LT::HSPEED; ++d)
+                            {
+                                unsigned int const curr = n*LT::OFF + d;
+                                T const f = pop.F_[pop. template AA_IndexRead<odd>(x_n,y_n,z_n,n,d,p)];
+                                rho += f;
+                                u   += f*LT::DX[curr];
+                                v   += f*LT::DY[curr];
+                                w   += f*LT::DZ[curr];
+                            }
+                        }
+
+                        if constexpr (has_force == true)
+                        {
+                            size_t const cell = (static_cast<size_t>(z)*NY + y)*NX + x;
+                            u += 0.5*force[3*cell + 0];
+                            v += 0.5*force[3*cell + 1];
+                            w += 0.5*force[3*cell + 2];
+                        }
+
+                        con(x, y, z, 0) = rho;
+                        con(x, y, z, 1) = u/rho;
+                        con(x, y, z, 2) = v/rho;
+                        con(x, y, z, 3) = w/rho;
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif // POPULATION_MACROSCOPIC_HPP_INCLUDED
@@ -12,11 +12,24 @@
 #include <cmath>
 #include <iostream>
 #include <memory>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string>
 #include <string.h>
+#include <type_traits>
+#ifdef __SSE2__
+    #include <immintrin.h>
+#endif
 
 #include "../general/memory_alignment.hpp"
 #include "../general/constexpr_func.hpp"
+#include "block_order.hpp"
+#include "block_schedule.hpp"
+#include "cell_flags.hpp"
+#include "population_propagation.hpp"
+
+/// header of the population back-up format (population_backup.hpp)
+struct backupHeader;
 
 
 /**\class  Population
@@ -25,9 +38,10 @@
  * \tparam NY     simulation domain resolution in y-direction
  * \tparam NZ     simulation domain resolution in z-direction
  * \tparam LT     static lattice::DdQq class containing discretisation parameters
- * \tparam NPOP   number of populations stored side by side in the lattice (default = 1)
+ * \tparam NPOP   number of populations interleaved per lattice velocity in the lattice (default = 1)
+ * \tparam PROP   propagation pattern (default = propagation::AA)
 */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP = 1>
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP = 1, class PROP = propagation::AA>
 class Population
 {
     public:
@@ -43,7 +57,8 @@ class Population
         static constexpr unsigned int PAD_ = LT::PAD;
         static constexpr unsigned int  ND_ = LT::ND;
         static constexpr unsigned int OFF_ = LT::OFF;
-        static constexpr size_t  MEM_SIZE_ = sizeof(T)*NZ*NY*NX*NPOP*static_cast<size_t>(ND_);
+        static constexpr size_t LATTICE_SIZE_ = static_cast<size_t>(NZ)*NY*NX*NPOP*ND_;   ///< number of values per lattice
+        static constexpr size_t     MEM_SIZE_ = sizeof(T)*LATTICE_SIZE_*PROP::LATTICES;
 
         /// parallelism: 3D blocks
         //  each cell gets a block of cells instead of a single cell
@@ -53,8 +68,20 @@ class Population
         static constexpr unsigned int NUM_BLOCKS_X_ = cef::ceil(static_cast<double>(NX) / BLOCK_SIZE_);
         static constexpr unsigned int   NUM_BLOCKS_ = NUM_BLOCKS_X_*NUM_BLOCKS_Y_*NUM_BLOCKS_Z_;        ///< total number of blocks
 
+        /// out-of-core: file descriptor of the file backing the populations (-1: main memory)
+        int storage_ = -1;
+
+        /// type of every cell: solid cells and loop blocks are skipped by the kernels
+        CellFlags<NX,NY,NZ,BLOCK_SIZE_> flags_;
+
+        /// order in which the loop blocks are swept: Morton curve
+        BlockOrder<NX,NY,NZ,BLOCK_SIZE_> order_;
+
+        /// cost-weighted partition of the loop blocks among the threads
+        BlockSchedule<NX,NY,NZ,BLOCK_SIZE_> schedule_;
+
         /// pointer to population
-        T* const F_ = static_cast<T*>(aligned_alloc(CACHE_LINE, MEM_SIZE_));
+        T* const F_;
 
         /// physical parameters
         T const NU_;            // kinematic simulation viscosity
@@ -69,9 +96,11 @@ class Population
          * \param U        characteristic velocity of the simulation in lattice units
          * \param L        characteristic length of the simulation in lattice units
          * \param LAMBDA   magic parameter for TRT collision operator
+         * \param storage  file backing the populations for lattices larger than main memory
+         *                 (default = "": main memory)
 		*/
-        Population(T const Re, T const U, unsigned int const L, T const LAMBDA = 0.25):
-            NU_(U*static_cast<T>(L) / Re), TAU_(NU_/(LT::CS*LT::CS) + 1.0/ 2.0), OMEGA_(1.0/TAU_),
+        Population(T const Re, T const U, unsigned int const L, T const LAMBDA = 0.25, std::string const& storage = ""):
+            order_(storage.empty() == false), F_(Allocate(storage)), NU_(U*static_cast<T>(L) / Re), TAU_(NU_/(LT::CS*LT::CS) + 1.0/ 2.0), OMEGA_(1.0/TAU_),
             LAMBDA_(LAMBDA), OMEGA_M_((TAU_ - 1.0/2.0) / (LAMBDA_ + 1.0/2.0*( TAU_ - 1.0/2.0)))
         {
             if (F_ == nullptr)
@@ -86,7 +115,7 @@ class Population
         ~Population()
         {
             std::cout << "See you, comrade!" << std::endl;
-            free(F_);
+            Deallocate();
         }
 
         /// indexing functions
@@ -117,13 +146,37 @@ class Population
         inline auto const& AA_Write(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
                                     unsigned int const n,       unsigned int const d,       unsigned int const p = 0) const;
 
+        template <bool odd>
+        inline void WriteCell(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                              T const (&f)[LT::ND],       unsigned int const p = 0);
+        template <bool odd>
+        inline void WriteCell(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                              T const (&f)[LT::ND][NPOP]);
+        template <size_t CELL_SIZE>
+        static inline void StreamCell(char* const cell, char const* const post);
+        inline void Fence() const;
+
+        /// memory management and out-of-core execution
+        T*   Allocate(std::string const& storage);
+        void Deallocate();
+        void PrefetchSlab(unsigned int const slab) const;
+        void ReleaseSlab(unsigned int const slab) const;
+        template <typename Kernel>
+        void SweepSlabs(Kernel const& kernel) const;
+
         /// import and export: population back-up
-        void Import(std::string const name);
-        void Export(std::string const name) const;
+        size_t Import(std::string const name, bool& odd);
+        void   Export(std::string const name, size_t const step = 0, bool const odd = false) const;
+        void   BackupHeader(backupHeader& header, size_t const step, bool const odd) const;
+        void   BackupChecksums(backupHeader const& header, uint64_t* const checksums) const;
+        bool   WriteBackupFile(char const* const fileName, backupHeader const& header, uint64_t const* const checksums,
+                               bool const parallel) const;
+        bool   WriteBackup(std::string const fileName, size_t const step, bool const odd) const;
 };
 
 /// include related header files
 #include "population_indexing.hpp"
 #include "population_backup.hpp"
+#include "population_storage.hpp"
 
 #endif // POPULATION_HPP_INCLUDED
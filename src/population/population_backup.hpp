@@ -4,61 +4,467 @@
 /**
  * \file     population_backup.hpp
  * \mainpage Class members for backing-up (export and import) microscopic populations
+ *
+ * \note     File layout: [header][chunk checksums][padding][populations]
+ *           The header holds everything that is required for validating and interpreting the
+ *           populations: lattice, resolution, floating precision, memory layout, the velocity of
+ *           every population slot as well as the time step and the parity of the A-A pattern.
+ *           The populations are stored as in memory and are divided into chunks of whole cells
+ *           that are written, read and validated in parallel. Back-ups with a different floating
+ *           precision or padding/ordering of the populations are converted on import.
 */
 
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <stdint.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
 
+#include "../general/checksum.hpp"
 #include "../general/paths.hpp"
 
 
+/// file identifier and version of the back-up format
+#define BACKUP_MAGIC         "LBTPOPUL"
+#define BACKUP_VERSION       2
+
+/// maximum number of population slots per cell that can be described by the header
+#define BACKUP_MAX_ND        64
+
+/// approximate size of a chunk in bytes
+#define BACKUP_CHUNK_SIZE    (16*1024*1024)
+
+/// alignment of the populations inside the file
+#define BACKUP_ALIGNMENT     4096
+
+
+/**\enum  backupLayout
+ * \brief Memory layouts of the populations
+*/
+enum backupLayout : uint32_t
+{
+    AA_CELL_MAJOR  = 0,  ///< A-A pattern, slots of every population contiguous: ((cell*NPOP + p)*ND + slot) (version 1)
+    AA_INTERLEAVED = 1   ///< A-A pattern, populations interleaved per slot: ((cell*ND + slot)*NPOP + p)
+};
+
+/**\struct backupHeader
+ * \brief  Plain header at the beginning of every population back-up
+*/
+struct backupHeader
+{
+    char     magic[8];                       ///< file identifier BACKUP_MAGIC
+    uint32_t version;                        ///< version of the format
+    uint32_t valueSize;                      ///< size of a single value in bytes (4: float, 8: double)
+    uint32_t DIM;                            ///< lattice: number of spatial dimensions
+    uint32_t SPEEDS;                         ///< lattice: number of discrete velocities
+    uint32_t ND;                             ///< lattice: number of slots per cell including padding
+    uint32_t OFF;                            ///< lattice: offset of the negative populations
+    uint32_t NX;                             ///< domain resolution
+    uint32_t NY;
+    uint32_t NZ;
+    uint32_t NPOP;                           ///< number of populations stored side by side
+    uint32_t layout;                         ///< memory layout (backupLayout)
+    uint32_t odd;                            ///< parity of the next time step: even (0) or odd (1)
+    uint64_t step;                           ///< number of completed time steps
+    uint64_t cellsPerChunk;                  ///< number of cells per chunk (last one may be smaller)
+    uint64_t numberOfChunks;                 ///< number of chunks
+    uint64_t checksumOffset;                 ///< position of the chunk checksums in the file
+    uint64_t dataOffset;                     ///< position of the populations in the file
+    int8_t   velocity[3][BACKUP_MAX_ND];     ///< discrete velocity of each slot
+    uint8_t  active[BACKUP_MAX_ND];          ///< slot holds a relevant population (1) or padding (0)
+};
+
+
+/**\fn          BackupWrite
+ * \brief       Write a buffer entirely to a position of a file. Only uses system calls (no heap, no
+ *              OpenMP) so that it is async-signal-safe and can be called from a forked child.
+ *
+ * \param[in]   fd       file descriptor
+ * \param[in]   data     buffer to be written
+ * \param[in]   bytes    size of the buffer in bytes
+ * \param[in]   offset   position in the file
+ * \return      Return true if the buffer was written entirely
+ */
+inline bool BackupWrite(int const fd, char const* const data, size_t const bytes, size_t const offset)
+{
+    size_t written = 0;
+    while (written < bytes)
+    {
+        ssize_t const result = pwrite(fd, data + written, bytes - written, offset + written);
+        if ((result < 0) && (errno == EINTR))
+        {
+            continue;
+        }
+        else if (result <= 0)
+        {
+            return false;
+        }
+        written += result;
+    }
+    return true;
+}
+
+/**\fn          BackupHeader
+ * \brief       Header of a back-up of the current populations
+ *
+ * \param[out]  header   header describing lattice, resolution, layout and chunks of the back-up
+ * \param[in]   step     number of completed time steps
+ * \param[in]   odd      parity of the next time step: even (0, false) or odd (1, true)
+ */
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP>
+void Population<NX,NY,NZ,LT,NPOP,PROP>::BackupHeader(backupHeader& header, size_t const step, bool const odd) const
+{
+    static_assert(ND_ <= BACKUP_MAX_ND, "Too many population slots for back-up header.");
+    static_assert(std::is_same<PROP,propagation::AA>::value == true, "Back-ups are restricted to the A-A pattern.");
+
+    constexpr size_t CELL_SIZE = sizeof(T)*NPOP*ND_;
+    constexpr size_t     CELLS = static_cast<size_t>(NX)*NY*NZ;
+
+    memset(&header, 0, sizeof(backupHeader));
+    memcpy(header.magic, BACKUP_MAGIC, sizeof(header.magic));
+    header.version        = BACKUP_VERSION;
+    header.valueSize      = sizeof(T);
+    header.DIM            = DIM_;
+    header.SPEEDS         = SPEEDS_;
+    header.ND             = ND_;
+    header.OFF            = OFF_;
+    header.NX             = NX;
+    header.NY             = NY;
+    header.NZ             = NZ;
+    header.NPOP           = NPOP;
+    header.layout         = AA_INTERLEAVED;
+    header.odd            = odd;
+    header.step           = step;
+    header.cellsPerChunk  = std::max(static_cast<size_t>(BACKUP_CHUNK_SIZE) / CELL_SIZE, static_cast<size_t>(1));
+    header.numberOfChunks = (CELLS + header.cellsPerChunk - 1) / header.cellsPerChunk;
+    header.checksumOffset = sizeof(backupHeader);
+    header.dataOffset     = BACKUP_ALIGNMENT*((header.checksumOffset + header.numberOfChunks*sizeof(uint64_t) + BACKUP_ALIGNMENT - 1) / BACKUP_ALIGNMENT);
+    for(unsigned int slot = 0; slot < ND_; ++slot)
+    {
+        header.velocity[0][slot] = static_cast<int8_t>(LT::DX[slot]);
+        header.velocity[1][slot] = static_cast<int8_t>(LT::DY[slot]);
+        header.velocity[2][slot] = static_cast<int8_t>(LT::DZ[slot]);
+        header.active[slot]      = (LT::MASK[slot] > 0.5);
+    }
+}
+
+/**\fn          BackupChecksums
+ * \brief       Checksums of all chunks of the current populations, evaluated in parallel
+ *
+ * \param[in]   header      header of the back-up (see BackupHeader)
+ * \param[out]  checksums   array holding the checksum of every chunk (header.numberOfChunks)
+ */
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP>
+void Population<NX,NY,NZ,LT,NPOP,PROP>::BackupChecksums(backupHeader const& header, uint64_t* const checksums) const
+{
+    constexpr size_t CELL_SIZE = sizeof(T)*NPOP*ND_;
+    constexpr size_t     CELLS = static_cast<size_t>(NX)*NY*NZ;
+
+    #pragma omp parallel for default(none) shared(header,checksums,CELLS,CELL_SIZE) schedule(dynamic,1)
+    for(size_t chunk = 0; chunk < header.numberOfChunks; ++chunk)
+    {
+        size_t const start = chunk*header.cellsPerChunk;
+        size_t const bytes = (std::min(start + header.cellsPerChunk, CELLS) - start)*CELL_SIZE;
+        checksums[chunk] = Checksum64(reinterpret_cast<char const*>(F_) + start*CELL_SIZE, bytes);
+    }
+}
+
+/**\fn          WriteBackupFile
+ * \brief       Write populations with a prepared header and chunk checksums to a file and flush it
+ *              to disk. The sequential variant only uses system calls (no heap, no OpenMP) so that it
+ *              is async-signal-safe and can be called from a forked child of a multithreaded process.
+ *
+ * \param[in]   fileName    path of the back-up file
+ * \param[in]   header      header of the back-up (see BackupHeader)
+ * \param[in]   checksums   checksum of every chunk (see BackupChecksums)
+ * \param[in]   parallel    write the chunks in parallel (true) or sequentially (false, forked child)
+ * \return      Return true if the back-up was written successfully
+ */
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP>
+bool Population<NX,NY,NZ,LT,NPOP,PROP>::WriteBackupFile(char const* const fileName, backupHeader const& header,
+                                                         uint64_t const* const checksums, bool const parallel) const
+{
+    constexpr size_t CELL_SIZE = sizeof(T)*NPOP*ND_;
+    constexpr size_t     CELLS = static_cast<size_t>(NX)*NY*NZ;
+
+    int const fd = open(fileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    bool success = BackupWrite(fd, reinterpret_cast<char const*>(&header), sizeof(backupHeader), 0);
+    success = success && BackupWrite(fd, reinterpret_cast<char const*>(checksums), header.numberOfChunks*sizeof(uint64_t), header.checksumOffset);
+
+    if (parallel == true)
+    {
+        #pragma omp parallel for default(none) shared(header,success,CELLS,CELL_SIZE) firstprivate(fd) schedule(dynamic,1)
+        for(size_t chunk = 0; chunk < header.numberOfChunks; ++chunk)
+        {
+            size_t const start = chunk*header.cellsPerChunk;
+            size_t const bytes = (std::min(start + header.cellsPerChunk, CELLS) - start)*CELL_SIZE;
+            if (BackupWrite(fd, reinterpret_cast<char const*>(F_) + start*CELL_SIZE, bytes, header.dataOffset + start*CELL_SIZE) == false)
+            {
+                #pragma omp atomic write
+                success = false;
+            }
+        }
+    }
+    else
+    {
+        success = success && BackupWrite(fd, reinterpret_cast<char const*>(F_), sizeof(T)*LATTICE_SIZE_, header.dataOffset);
+    }
+    success = success && (fsync(fd) == 0);
+    success = (close(fd) == 0) && success;
+
+    return success;
+}
+
+/**\fn          WriteBackup
+ * \brief       Write populations with header and chunk checksums in parallel to a file and flush it
+ *              to disk. Does not terminate the program on failure.
+ *
+ * \param[in]   fileName   path of the back-up file
+ * \param[in]   step       number of completed time steps
+ * \param[in]   odd        parity of the next time step: even (0, false) or odd (1, true)
+ * \return      Return true if the back-up was written successfully
+ */
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP>
+bool Population<NX,NY,NZ,LT,NPOP,PROP>::WriteBackup(std::string const fileName, size_t const step, bool const odd) const
+{
+    backupHeader header;
+    BackupHeader(header, step, odd);
+
+    std::vector<uint64_t> checksums(header.numberOfChunks, 0);
+    BackupChecksums(header, checksums.data());
+
+    return WriteBackupFile(fileName.c_str(), header, checksums.data(), true);
+}
+
+/**\fn          ConvertBackupChunk
+ * \brief       Convert populations of a chunk that was stored with a different floating precision,
+ *              slot layout or memory layout into the interleaved layout of the simulation
+ *
+ * \tparam      FT        floating data type of the back-up
+ * \tparam      T         floating data type used for simulation
+ * \param[in]   in        populations of the chunk as stored in the back-up
+ * \param[out]  out       populations of the chunk in the memory layout of the simulation
+ * \param[in]   cells     number of cells of the chunk
+ * \param[in]   NPOP      number of populations per cell
+ * \param[in]   ND_in     number of slots per cell of the back-up
+ * \param[in]   ND_out    number of slots per cell of the simulation
+ * \param[in]   mapping   slot in the back-up for every slot of the simulation (-1 for padding)
+ * \param[in]   layout    memory layout of the back-up (backupLayout)
+ */
+template <typename FT, typename T>
+void ConvertBackupChunk(FT const* const in, T* const out, size_t const cells, unsigned int const NPOP,
+                        unsigned int const ND_in, unsigned int const ND_out, int const* const mapping, uint32_t const layout)
+{
+    for(size_t cell = 0; cell < cells; ++cell)
+    {
+        for(unsigned int slot = 0; slot < ND_out; ++slot)
+        {
+            for(unsigned int p = 0; p < NPOP; ++p)
+            {
+                if (mapping[slot] < 0)
+                {
+                    out[(cell*ND_out + slot)*NPOP + p] = static_cast<T>(0);
+                    continue;
+                }
+
+                size_t const source = (layout == AA_INTERLEAVED) ? (cell*ND_in + mapping[slot])*NPOP + p
+                                                                 : (cell*NPOP + p)*ND_in + mapping[slot];
+                out[(cell*ND_out + slot)*NPOP + p] = static_cast<T>(in[source]);
+            }
+        }
+    }
+}
+
 /**\fn          Import
- * \brief       Import populations from a *.bin file (initialisation)
- * \warning     Please make sure the correct resolution is selected and run the
- *              initialisation of populations afterwards.
+ * \brief       Import populations from a *.bin back-up. The back-up is validated against the
+ *              lattice and resolution and the checksum of every chunk is verified. Back-ups written
+ *              with a different floating precision or population padding are converted, back-ups of
+ *              version 1 with more than one population are transposed to the interleaved layout.
  *
- * \param[in]   name   the import file name of the scalar
+ * \param[in]   name   the import file name of the back-up
+ * \param[out]  odd    parity of the next time step: even (0, false) or odd (1, true)
+ * \return      Number of completed time steps at the time of the back-up
  */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP>
-void Population<NX,NY,NZ,LT,NPOP>::Import(std::string const name)
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP>
+size_t Population<NX,NY,NZ,LT,NPOP,PROP>::Import(std::string const name, bool& odd)
 {
+    static_assert(std::is_same<PROP,propagation::AA>::value == true, "Back-ups are restricted to the A-A pattern.");
+
     std::string const fileName = BACKUP_IMPORT_PATH + std::string("/") + name + std::string(".bin");
-    FILE * const importFile;
 
-    if(fopen(fileName.c_str(), "rb+") != nullptr)
+    int const fd = open(fileName.c_str(), O_RDONLY);
+    backupHeader header;
+    if ((fd < 0) || (pread(fd, &header, sizeof(backupHeader), 0) != sizeof(backupHeader)) ||
+        (memcmp(header.magic, BACKUP_MAGIC, sizeof(header.magic)) != 0))
     {
-        importFile = fopen(fileName.c_str(), "rb+");
-        fread(F_, 1, MEM_SIZE_, importFile);
-        fclose(importFile);
+        std::cerr << "Fatal error: Could not import population back-up '" << fileName << "'." << std::endl;
+        exit(EXIT_FAILURE);
+    }
 
+    /// validate back-up
+    if ((header.version < 1) || (header.version > BACKUP_VERSION))
+    {
+        std::cerr << "Fatal error: Back-up version " << header.version << " is not supported." << std::endl;
+        exit(EXIT_FAILURE);
     }
-    else
+    if ((header.NX != NX) || (header.NY != NY) || (header.NZ != NZ) || (header.NPOP != NPOP))
     {
-        std::cerr << "Error: Could not import population from disk." << std::endl;
+        std::cerr << "Fatal error: Back-up resolution " << header.NX << "x" << header.NY << "x" << header.NZ << " (" << header.NPOP
+                  << " populations) does not match simulation." << std::endl;
         exit(EXIT_FAILURE);
     }
+    if ((header.DIM != DIM_) || (header.SPEEDS != SPEEDS_) || (header.ND > BACKUP_MAX_ND) ||
+        (header.layout != ((header.version == 1) ? AA_CELL_MAJOR : AA_INTERLEAVED)) ||
+        ((header.valueSize != sizeof(float)) && (header.valueSize != sizeof(double))))
+    {
+        std::cerr << "Fatal error: Back-up of lattice D" << header.DIM << "Q" << header.SPEEDS << " with layout " << header.layout
+                  << " can't be imported." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    /// slot of the back-up for every slot of the simulation by comparing the discrete velocities
+    int  mapping[ND_];
+    bool identical = (header.valueSize == sizeof(T)) && (header.ND == ND_) && ((header.layout == AA_INTERLEAVED) || (NPOP == 1));
+    for(unsigned int slot = 0; slot < ND_; ++slot)
+    {
+        mapping[slot] = -1;
+        if (LT::MASK[slot] < 0.5)
+        {
+            continue;
+        }
+
+        for(unsigned int s = 0; s < header.ND; ++s)
+        {
+            if ((header.active[s] != 0) &&
+                (header.velocity[0][s] == static_cast<int8_t>(LT::DX[slot])) &&
+                (header.velocity[1][s] == static_cast<int8_t>(LT::DY[slot])) &&
+                (header.velocity[2][s] == static_cast<int8_t>(LT::DZ[slot])))
+            {
+                mapping[slot] = s;
+                break;
+            }
+        }
+
+        if (mapping[slot] < 0)
+        {
+            std::cerr << "Fatal error: Back-up does not hold population " << slot << " of the lattice." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        identical = identical && (mapping[slot] == static_cast<int>(slot));
+    }
+
+    /// read, validate and convert chunks in parallel
+    constexpr size_t CELLS = static_cast<size_t>(NX)*NY*NZ;
+    size_t const CELL_SIZE = static_cast<size_t>(header.valueSize)*NPOP*header.ND;
+
+    std::vector<uint64_t> checksums(header.numberOfChunks, 0);
+    size_t const checksumBytes = header.numberOfChunks*sizeof(uint64_t);
+    if ((header.cellsPerChunk == 0) || (header.numberOfChunks != (CELLS + header.cellsPerChunk - 1) / header.cellsPerChunk) ||
+        (pread(fd, checksums.data(), checksumBytes, header.checksumOffset) != static_cast<ssize_t>(checksumBytes)))
+    {
+        std::cerr << "Fatal error: Back-up '" << fileName << "' is corrupted." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    size_t failures = 0;
+    #pragma omp parallel default(none) shared(header,checksums,mapping,identical,failures,CELLS) firstprivate(fd,CELL_SIZE)
+    {
+        std::vector<char> buffer(identical ? 0 : header.cellsPerChunk*CELL_SIZE);
+
+        #pragma omp for schedule(dynamic,1) reduction(+:failures)
+        for(size_t chunk = 0; chunk < header.numberOfChunks; ++chunk)
+        {
+            size_t const start = chunk*header.cellsPerChunk;
+            size_t const cells = std::min(start + header.cellsPerChunk, CELLS) - start;
+            size_t const bytes = cells*CELL_SIZE;
+            char* const   data = identical ? reinterpret_cast<char*>(F_ + start*NPOP*ND_) : buffer.data();
+
+            size_t read = 0;
+            while (read < bytes)
+            {
+                ssize_t const result = pread(fd, data + read, bytes - read, header.dataOffset + start*CELL_SIZE + read);
+                if ((result < 0) && (errno == EINTR))
+                {
+                    continue;
+                }
+                else if (result <= 0)
+                {
+                    break;
+                }
+                read += result;
+            }
+
+            if ((read != bytes) || (Checksum64(data, bytes) != checksums[chunk]))
+            {
+                ++failures;
+                continue;
+            }
+
+            if (identical == false)
+            {
+                T* const out = F_ + start*NPOP*ND_;
+                if (header.valueSize == sizeof(float))
+                {
+                    ConvertBackupChunk(reinterpret_cast<float const*>(data), out, cells, NPOP, header.ND, ND_, mapping, header.layout);
+                }
+                else
+                {
+                    ConvertBackupChunk(reinterpret_cast<double const*>(data), out, cells, NPOP, header.ND, ND_, mapping, header.layout);
+                }
+            }
+        }
+    }
+    close(fd);
+
+    if (failures > 0)
+    {
+        std::cerr << "Fatal error: " << failures << " chunks of back-up '" << fileName << "' are corrupted." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    odd = (header.odd != 0);
+    return header.step;
 }
 
 /**\fn          Export
- * \brief       Export populations at current time step to *.bin file
+ * \brief       Export populations at current time step to *.bin file. The back-up is written
+ *              to a temporary file first that replaces an existing back-up only once complete.
  *
- * \param[in]   name   the export file name of the scalar
+ * \param[in]   name   the export file name of the back-up
+ * \param[in]   step   number of completed time steps (default = 0)
+ * \param[in]   odd    parity of the next time step: even (0, false) or odd (1, true) (default = even)
  */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP>
-void Population<NX,NY,NZ,LT,NPOP>::Export(std::string const name) const
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP>
+void Population<NX,NY,NZ,LT,NPOP,PROP>::Export(std::string const name, size_t const step, bool const odd) const
 {
     struct stat info;
 
     if (stat(BACKUP_EXPORT_PATH.c_str(), &info) == 0 && S_ISDIR(info.st_mode))
     {
         std::string const fileName = BACKUP_EXPORT_PATH + std::string("/") + name + std::string(".bin");
-        FILE * const exportFile;
+        std::string const tempName = fileName + std::string(".tmp");
 
-        exportFile = fopen(fileName.c_str(), "wb+");
-        fwrite(F_, 1, MEM_SIZE_, exportFile);
-        fclose(exportFile);
+        if ((WriteBackup(tempName, step, odd) == false) || (rename(tempName.c_str(), fileName.c_str()) != 0))
+        {
+            unlink(tempName.c_str());
+            std::cerr << "Fatal error: Could not export population to '" << fileName << "'." << std::endl;
+            exit(EXIT_FAILURE);
+        }
     }
     else
     {
@@ -0,0 +1,115 @@
+#ifndef POPULATION_BACKUP_UNIT_TEST_HPP_INCLUDED
+#define POPULATION_BACKUP_UNIT_TEST_HPP_INCLUDED
+
+/**
+ * \file     population_backup_unit_test.hpp
+ * \mainpage Unit test for the population back-up: round trip of several interleaved populations and
+ *           import of back-ups written in the cell-major layout of version 1
+*/
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <string.h>
+#include <vector>
+
+#include "../general/checksum.hpp"
+#include "../general/paths.hpp"
+#include "../lattice/D3Q19.hpp"
+#include "population.hpp"
+
+
+/**\fn     UnitTestBackup
+ * \brief  Export a lattice holding several populations, import it again and compare it bitwise to
+ *         the original values. The same back-up is then rewritten in the layout of version 1 (all
+ *         slots of a population contiguous) and has to be transposed back on import.
+ *
+ * \return EXIT_SUCCESS if the test passed, else EXIT_FAILURE
+*/
+inline int UnitTestBackup()
+{
+    constexpr unsigned int   NX = 9;
+    constexpr unsigned int   NY = 7;
+    constexpr unsigned int   NZ = 5;
+    constexpr unsigned int NPOP = 3;
+    typedef lattice::D3Q19<double> DdQq;
+    typedef Population<NX,NY,NZ,DdQq,NPOP> Lattice;
+    std::string const name = "unit_test";
+    std::string const fileName = BACKUP_EXPORT_PATH + std::string("/") + name + std::string(".bin");
+
+    Lattice Micro(100.0, 0.05, NY);
+    // padding slots hold no information and are zeroed by a conversion
+    for(size_t i = 0; i < Lattice::LATTICE_SIZE_; ++i)
+    {
+        Micro.F_[i] = (DdQq::MASK[(i/NPOP) % Lattice::ND_] > 0.5) ? 0.5 + 1e-3*i : 0.0;
+    }
+    std::vector<double> const original(Micro.F_, Micro.F_ + Lattice::LATTICE_SIZE_);
+    Micro.Export(name, 42, true);
+
+    auto const Compare = [&](char const* const description) -> int
+    {
+        memset(Micro.F_, 0, sizeof(double)*Lattice::LATTICE_SIZE_);
+        bool odd = false;
+        size_t const step = Micro.Import(name, odd);
+
+        if ((step != 42) || (odd == false) || (memcmp(Micro.F_, original.data(), sizeof(double)*Lattice::LATTICE_SIZE_) != 0))
+        {
+            std::cerr << "Error: Import of the " << description << " back-up differs from the original." << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    };
+    int result = Compare("interleaved");
+
+    /// rewrite the back-up in the cell-major layout of version 1 with new checksums
+    std::vector<char> file;
+    {
+        std::ifstream input(fileName, std::ios::binary);
+        file.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    }
+    backupHeader header;
+    memcpy(&header, file.data(), sizeof(backupHeader));
+    header.version = 1;
+    header.layout  = AA_CELL_MAJOR;
+    memcpy(file.data(), &header, sizeof(backupHeader));
+
+    constexpr size_t CELLS = static_cast<size_t>(NX)*NY*NZ;
+    double* const data = reinterpret_cast<double*>(file.data() + header.dataOffset);
+    for(size_t cell = 0; cell < CELLS; ++cell)
+    {
+        for(unsigned int p = 0; p < NPOP; ++p)
+        {
+            for(unsigned int slot = 0; slot < Lattice::ND_; ++slot)
+            {
+                data[(cell*NPOP + p)*Lattice::ND_ + slot] = original[(cell*Lattice::ND_ + slot)*NPOP + p];
+            }
+        }
+    }
+
+    size_t const CELL_SIZE = sizeof(double)*NPOP*Lattice::ND_;
+    uint64_t* const checksums = reinterpret_cast<uint64_t*>(file.data() + header.checksumOffset);
+    for(size_t chunk = 0; chunk < header.numberOfChunks; ++chunk)
+    {
+        size_t const start = chunk*header.cellsPerChunk;
+        size_t const cells = std::min(start + header.cellsPerChunk, CELLS) - start;
+        checksums[chunk] = Checksum64(file.data() + header.dataOffset + start*CELL_SIZE, cells*CELL_SIZE);
+    }
+
+    {
+        std::ofstream output(fileName, std::ios::binary | std::ios::trunc);
+        output.write(file.data(), file.size());
+    }
+    if (Compare("version 1") != EXIT_SUCCESS)
+    {
+        result = EXIT_FAILURE;
+    }
+
+    remove(fileName.c_str());
+    return result;
+}
+
+#endif // POPULATION_BACKUP_UNIT_TEST_HPP_INCLUDED
@@ -0,0 +1,359 @@
+#ifndef POPULATION_CHECKPOINT_HPP_INCLUDED
+#define POPULATION_CHECKPOINT_HPP_INCLUDED
+
+/**
+ * \file     population_checkpoint.hpp
+ * \brief    Periodic non-blocking checkpoints of the microscopic populations
+ *
+ * \mainpage Writing the entire population array to disk takes several seconds for large lattices.
+ *           Instead of stalling the solver the checkpoint scheduler forks a writer process: the
+ *           child inherits a copy-on-write snapshot of the populations and writes it to disk while
+ *           the parent keeps on stepping. Header and chunk checksums are evaluated by the parent in
+ *           parallel before forking, the child only calls async-signal-safe system calls. Only
+ *           pages modified by the solver during the write are duplicated by the operating system,
+ *           so the overhead is a fork (copy of the page tables) and at most one copy of every page
+ *           per checkpoint.
+ *           Every checkpoint is written to a temporary file that is renamed only after it has been
+ *           flushed to disk, therefore a checkpoint on disk is always complete. Only the latest
+ *           checkpoints are kept, including those left on disk by earlier runs. A SIGTERM (e.g.
+ *           from a batch system before the wall time is over) is caught and results in a final
+ *           blocking checkpoint.
+ * \warning  In the worst case the memory consumption of a running writer equals the size of the
+ *           population array.
+*/
+
+#include <algorithm>
+#include <deque>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <iostream>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "../general/paths.hpp"
+#include "../general/timer.hpp"
+#include "population.hpp"
+
+
+/// flag set asynchronously by the signal handler
+static volatile sig_atomic_t checkpointTerminationRequested = 0;
+
+/**\fn        CheckpointSignalHandler
+ * \brief     Signal handler that only marks that a termination was requested
+ *
+ * \param[in] signal   number of the received signal
+*/
+extern "C" inline void CheckpointSignalHandler(int const signal)
+{
+    (void)signal;
+    checkpointTerminationRequested = 1;
+}
+
+
+/**\class  Checkpoint
+ * \brief  Scheduler for periodic copy-on-write checkpoints of a population
+ * \note   Checkpoints must only be taken after an odd time step, when the populations are in their
+ *         regular order for the following even time step.
+ *
+ * \tparam NX     simulation domain resolution in x-direction
+ * \tparam NY     simulation domain resolution in y-direction
+ * \tparam NZ     simulation domain resolution in z-direction
+ * \tparam LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam NPOP   number of populations stored side by side in the lattice
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP = 1>
+class Checkpoint
+{
+    private:
+        Population<NX,NY,NZ,LT,NPOP> const& pop_;
+
+        double       const interval_;         ///< wall time between two checkpoints in seconds
+        unsigned int const keep_;             ///< number of checkpoints kept on disk
+        std::string  const name_;             ///< prefix of the checkpoint files
+
+        Timer                    timer_;      ///< time since last checkpoint
+        pid_t                    writer_;     ///< process id of running writer (-1: none)
+        unsigned int             writerStep_; ///< time step of the checkpoint that is being written
+        std::deque<unsigned int> steps_;      ///< time steps of the completed checkpoints on disk
+        struct sigaction         previous_;   ///< previous SIGTERM handler
+
+        /**\fn        FileName
+         * \brief     Name of the checkpoint file of a certain time step
+         *
+         * \param[in] step   time step of the checkpoint
+         * \return    Path of the checkpoint file
+        */
+        std::string FileName(unsigned int const step) const
+        {
+            return BACKUP_EXPORT_PATH + std::string("/") + name_ + std::string("_") + std::to_string(step) + std::string(".bin");
+        }
+
+        /**\fn        WriteFile
+         * \brief     Write populations with a prepared header and checksums to a temporary file, flush
+         *            it to disk and rename it. Only uses system calls (no heap, no OpenMP) so that it is
+         *            async-signal-safe and can be called from a forked child of a multithreaded process.
+         *
+         * \param[in] fileName    path of the checkpoint file
+         * \param[in] tempName    path of the temporary file
+         * \param[in] header      header of the back-up
+         * \param[in] checksums   checksum of every chunk of the back-up
+         * \return    Return true if the checkpoint was written successfully
+        */
+        bool WriteFile(char const* const fileName, char const* const tempName, backupHeader const& header,
+                       uint64_t const* const checksums) const
+        {
+            bool const success = pop_.WriteBackupFile(tempName, header, checksums, false) && (rename(tempName, fileName) == 0);
+            if (success == false)
+            {
+                unlink(tempName);
+            }
+            return success;
+        }
+
+        /**\fn        Collect
+         * \brief     Check if the running writer has finished and rotate the checkpoints on disk
+         *
+         * \param[in] block   wait for the writer to finish (true) or only poll it (false)
+        */
+        void Collect(bool const block)
+        {
+            if (writer_ < 0)
+            {
+                return;
+            }
+
+            int status = 0;
+            pid_t result = 0;
+            do
+            {
+                result = waitpid(writer_, &status, block ? 0 : WNOHANG);
+            } while ((result < 0) && (errno == EINTR));
+
+            if (result == 0)
+            {
+                return;
+            }
+
+            if ((result == writer_) && WIFEXITED(status) && (WEXITSTATUS(status) == EXIT_SUCCESS))
+            {
+                Register(writerStep_);
+            }
+            else
+            {
+                std::cerr << "Error: Checkpoint of time step " << writerStep_ << " could not be written." << std::endl;
+            }
+            writer_ = -1;
+        }
+
+        /**\fn        Register
+         * \brief     Register a completed checkpoint and remove the oldest ones
+         *
+         * \param[in] step   time step of the completed checkpoint
+        */
+        void Register(unsigned int const step)
+        {
+            // a checkpoint of an earlier run with the same time step has been overwritten
+            steps_.erase(std::remove(steps_.begin(), steps_.end(), step), steps_.end());
+            steps_.push_back(step);
+            while (steps_.size() > keep_)
+            {
+                unlink(FileName(steps_.front()).c_str());
+                steps_.pop_front();
+            }
+        }
+
+        /**\fn        Scan
+         * \brief     Register the checkpoints left on disk by earlier runs (in the order of their time
+         *            steps) so that they are rotated as well, and remove incomplete temporary files
+        */
+        void Scan()
+        {
+            DIR* const directory = opendir(BACKUP_EXPORT_PATH.c_str());
+            if (directory == nullptr)
+            {
+                return;
+            }
+
+            std::string const prefix = name_ + std::string("_");
+            std::vector<unsigned int> steps;
+            for(struct dirent const* entry = readdir(directory); entry != nullptr; entry = readdir(directory))
+            {
+                std::string const file = entry->d_name;
+                size_t const digits = file.find_first_not_of("0123456789", prefix.size());
+                if ((file.compare(0, prefix.size(), prefix) != 0) || (digits == prefix.size()) || (digits == std::string::npos))
+                {
+                    continue;
+                }
+
+                unsigned int const step = static_cast<unsigned int>(strtoul(file.c_str() + prefix.size(), nullptr, 10));
+                if (file.compare(digits, std::string::npos, ".bin") == 0)
+                {
+                    steps.push_back(step);
+                }
+                else if (file.compare(digits, std::string::npos, ".bin.tmp") == 0)
+                {
+                    unlink((BACKUP_EXPORT_PATH + std::string("/") + file).c_str());
+                }
+            }
+            closedir(directory);
+
+            std::sort(steps.begin(), steps.end());
+            for(unsigned int const step: steps)
+            {
+                Register(step);
+            }
+        }
+
+    public:
+        /**\brief     Class constructor: installs the SIGTERM handler and registers the checkpoints on disk
+         *
+         * \param[in] pop        population object holding microscopic variables
+         * \param[in] interval   wall time between two checkpoints in seconds
+         * \param[in] keep       number of checkpoints kept on disk (default = 2)
+         * \param[in] name       prefix of the checkpoint files (default = "checkpoint")
+        */
+        Checkpoint(Population<NX,NY,NZ,LT,NPOP> const& pop, double const interval, unsigned int const keep = 2,
+                   std::string const& name = "checkpoint"):
+            pop_(pop), interval_(interval), keep_(std::max(keep, 1u)), name_(name),
+            timer_(), writer_(-1), writerStep_(0), steps_(), previous_()
+        {
+            struct stat info;
+
+            if (stat(BACKUP_EXPORT_PATH.c_str(), &info) != 0 || !S_ISDIR(info.st_mode))
+            {
+                std::cerr << "Fatal error: Directory '" << BACKUP_EXPORT_PATH << "' not found." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            Scan();
+
+            struct sigaction action;
+            memset(&action, 0, sizeof(action));
+            action.sa_handler = CheckpointSignalHandler;
+            sigemptyset(&action.sa_mask);
+            sigaction(SIGTERM, &action, &previous_);
+
+            timer_.Start();
+        }
+
+        Checkpoint(Checkpoint const&) = delete;
+        Checkpoint& operator= (Checkpoint const&) = delete;
+
+        /**\brief Class destructor: waits for running writer and restores previous SIGTERM handler
+        */
+        ~Checkpoint()
+        {
+            Collect(true);
+            sigaction(SIGTERM, &previous_, nullptr);
+        }
+
+        /**\fn        Update
+         * \brief     Start a new checkpoint in the background if the interval has passed. If a
+         *            termination was requested a final checkpoint is written before returning.
+         *
+         * \param[in] step   number of completed time steps (after an odd time step)
+         * \return    Return true if the simulation should terminate
+        */
+        bool Update(unsigned int const step)
+        {
+            Collect(false);
+
+            if (checkpointTerminationRequested != 0)
+            {
+                std::cout << "Termination requested: writing final checkpoint..." << std::endl;
+                Write(step);
+                return true;
+            }
+
+            // a slow writer is never waited for: the checkpoint is delayed instead
+            if ((timer_.GetRuntime() < interval_) || (writer_ >= 0))
+            {
+                return false;
+            }
+
+            // a shared file mapping (out-of-core) is not copied on write: checkpoint is blocking
+            if (pop_.storage_ >= 0)
+            {
+                Write(step);
+                timer_.Start();
+                return false;
+            }
+
+            // names, header and checksums are created before forking: the child only performs system
+            // calls, as heap and OpenMP locks may be held by threads that do not exist in the child
+            std::string const fileName = FileName(step);
+            std::string const tempName = fileName + std::string(".tmp");
+            char const* const fileChars = fileName.c_str();
+            char const* const tempChars = tempName.c_str();
+
+            backupHeader header;
+            pop_.BackupHeader(header, step, false);
+            std::vector<uint64_t> checksums(header.numberOfChunks, 0);
+            pop_.BackupChecksums(header, checksums.data());
+            uint64_t const* const checksumData = checksums.data();
+
+            fflush(stdout);
+            fflush(stderr);
+            pid_t const pid = fork();
+            if (pid == 0)
+            {
+                _exit(WriteFile(fileChars, tempChars, header, checksumData) ? EXIT_SUCCESS : EXIT_FAILURE);
+            }
+            else if (pid < 0)
+            {
+                std::cerr << "Error: Could not fork checkpoint writer, writing checkpoint blocking." << std::endl;
+                Write(step);
+            }
+            else
+            {
+                writer_     = pid;
+                writerStep_ = step;
+            }
+
+            timer_.Start();
+            return false;
+        }
+
+        /**\fn        Write
+         * \brief     Write a checkpoint blocking, after the running writer has finished
+         *
+         * \param[in] step   number of completed time steps (after an odd time step)
+        */
+        void Write(unsigned int const step)
+        {
+            Collect(true);
+
+            std::string const fileName = FileName(step);
+            std::string const tempName = fileName + std::string(".tmp");
+            if ((pop_.WriteBackup(tempName, step, false) == true) && (rename(tempName.c_str(), fileName.c_str()) == 0))
+            {
+                Register(step);
+            }
+            else
+            {
+                unlink(tempName.c_str());
+                std::cerr << "Error: Checkpoint of time step " << step << " could not be written." << std::endl;
+            }
+        }
+
+        /**\fn     GetLatestStep
+         * \brief  Time step of the latest completed checkpoint
+         *
+         * \return Time step of the latest checkpoint on disk or zero if there is none
+        */
+        unsigned int GetLatestStep() const
+        {
+            return steps_.empty() ? 0 : steps_.back();
+        }
+};
+
+#endif // POPULATION_CHECKPOINT_HPP_INCLUDED
@@ -3,7 +3,7 @@
 
 /**
  * \file     population_indexing.hpp
- * \brief    Class members for indexing of populations with A-A access pattern
+ * \brief    Class members for indexing of populations with the selected propagation pattern
  *
  * \mainpage The A-A access pattern avoids the usage of two distinct populations before and
  *           after streaming by treating even and odd time steps differently: Even time steps
@@ -12,6 +12,8 @@
  *           step with a regular read and a reverse write.
  *           This is implemented by different macros that determine the population indices for
  *           even and odd time steps.
+ *           Other propagation patterns (see population_propagation.hpp) are selected by the template
+ *           parameter PROP of the population and are mapped to the same indexing functions.
  *
  * \note     "Accelerating Lattice Boltzmann Fluid Flow Simulations Using Graphics Processors"
  *           P. Bailey, J. Myre, S.D.C. Walsh, D.J. Lilja, M.O. Saar
@@ -32,6 +34,8 @@
 
 /**\fn         SpatialToLinear
  * \brief      Inline function for converting 3D population coordinates to scalar index
+ * \note       The NPOP populations of a cell are interleaved: the same lattice velocity of all populations
+ *             is contiguous and can be processed in SIMD lanes.
  * \warning    Inline function! Has to be declared in header!
  *
  * \param[in]  x   x coordinate of cell
@@ -42,11 +46,11 @@
  * \param[in]  p   relevant population (default = 0)
  * \return     requested linear population index
 */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP>
-inline size_t __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::SpatialToLinear(unsigned int const x, unsigned int const y, unsigned int const z,
-                                                                                           unsigned int const n, unsigned int const d, unsigned int const p) const
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP>
+inline size_t __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP,PROP>::SpatialToLinear(unsigned int const x, unsigned int const y, unsigned int const z,
+                                                                                                unsigned int const n, unsigned int const d, unsigned int const p) const
 {
-    return (((z*NY + y)*NX + x)*NPOP + p)*LT::ND + n*LT::OFF + d;
+    return (((static_cast<size_t>(z)*NY + y)*NX + x)*LT::ND + n*LT::OFF + d)*NPOP + p;
 }
 
 
@@ -61,17 +65,17 @@ inline size_t __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::Spati
  * \param[out] d       return value number of relevant population index
  * \param[in]  index   current linear population index
 */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP>
-void Population<NX,NY,NZ,LT,NPOP>::LinearToSpatial(unsigned int& x, unsigned int& y, unsigned int& z,
-                                                   unsigned int& p, unsigned int& n, unsigned int& d,
-                                                   size_t const index) const
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP>
+void Population<NX,NY,NZ,LT,NPOP,PROP>::LinearToSpatial(unsigned int& x, unsigned int& y, unsigned int& z,
+                                                        unsigned int& p, unsigned int& n, unsigned int& d,
+                                                        size_t const index) const
 {
-    size_t factor = LT::ND*NPOP*NX*NY;
+    size_t factor = static_cast<size_t>(LT::ND)*NPOP*NX*NY;
     size_t rest   = index%factor;
 
     z      = index/factor;
 
-    factor = LT::ND*NPOP*NX;
+    factor = static_cast<size_t>(LT::ND)*NPOP*NX;
     y      = rest/factor;
     rest   = rest%factor;
 
@@ -79,16 +83,13 @@ void Population<NX,NY,NZ,LT,NPOP>::LinearToSpatial(unsigned int& x, unsigned int
     x      = rest/factor;
     rest   = rest%factor;
 
-    factor = LT::ND;
-    p      = rest/factor;
-    rest   = rest%factor;
-
-    factor = LT::OFF;
+    factor = LT::OFF*NPOP;
     n      = rest/factor;
     rest   = rest%factor;
 
-    factor = LT::SPEEDS;
-    d      = rest%factor;
+    factor = NPOP;
+    d      = rest/factor;
+    p      = rest%factor;
 }
 
 
@@ -105,15 +106,12 @@ void Population<NX,NY,NZ,LT,NPOP>::LinearToSpatial(unsigned int& x, unsigned int
  * \param[in]  p     relevant population (default = 0)
  * \return     requested linear population index before collision
 */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP> template <bool odd>
-inline size_t __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::AA_IndexRead(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
-                                                                                        unsigned int const n,       unsigned int const d,       unsigned int const p) const
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP> template <bool odd>
+inline size_t __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP,PROP>::AA_IndexRead(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                                                                             unsigned int const n,       unsigned int const d,       unsigned int const p) const
 {
-    return SpatialToLinear(x[1 + O_E(odd, static_cast<int>(LT::DX[!n*OFF_+d]), 0)],
-                           y[1 + O_E(odd, static_cast<int>(LT::DY[!n*OFF_+d]), 0)],
-                           z[1 + O_E(odd, static_cast<int>(LT::DZ[!n*OFF_+d]), 0)],
-                           O_E(odd, n, !n),
-                           d, p);
+    propagation::Access const a = PROP::template Read<odd,LT>(n,d);
+    return a.lattice*LATTICE_SIZE_ + SpatialToLinear(x[a.x], y[a.y], z[a.z], a.n, d, p);
 }
 
 /**\fn         AA_IndexWrite
@@ -129,15 +127,12 @@ inline size_t __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::AA_In
  * \param[in]  p     relevant population (default = 0)
  * \return     requested linear population index after collision
 */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP> template <bool odd>
-inline size_t __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::AA_IndexWrite(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
-                                                                                         unsigned int const n,       unsigned int const d,       unsigned int const p) const
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP> template <bool odd>
+inline size_t __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP,PROP>::AA_IndexWrite(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                                                                              unsigned int const n,       unsigned int const d,       unsigned int const p) const
 {
-    return SpatialToLinear(x[1 + O_E(odd, static_cast<int>(LT::DX[n*OFF_+d]), 0)],
-                           y[1 + O_E(odd, static_cast<int>(LT::DY[n*OFF_+d]), 0)],
-                           z[1 + O_E(odd, static_cast<int>(LT::DZ[n*OFF_+d]), 0)],
-                           O_E(odd, !n, n),
-                           d, p);
+    propagation::Access const a = PROP::template Write<odd,LT>(n,d);
+    return a.lattice*LATTICE_SIZE_ + SpatialToLinear(x[a.x], y[a.y], z[a.z], a.n, d, p);
 }
 
 
@@ -154,16 +149,16 @@ inline size_t __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::AA_In
  * \param[in]  p     relevant population (default = 0)
  * \return     requested linear population index before collision (reading)
 */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP> template <bool odd>
-inline auto& __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::AA_Read(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
-                                                                                  unsigned int const n,       unsigned int const d,       unsigned int const p)
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP> template <bool odd>
+inline auto& __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP,PROP>::AA_Read(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                                                                       unsigned int const n,       unsigned int const d,       unsigned int const p)
 {
     return F_[AA_IndexRead<odd>(x,y,z,n,d,p)];
 }
 
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP> template <bool odd>
-inline auto const& __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::AA_Read(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
-                                                                                        unsigned int const n,       unsigned int const d,       unsigned int const p) const
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP> template <bool odd>
+inline auto const& __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP,PROP>::AA_Read(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                                                                             unsigned int const n,       unsigned int const d,       unsigned int const p) const
 {
     return F_[AA_IndexRead<odd>(x,y,z,n,d,p)];
 }
@@ -181,18 +176,165 @@ inline auto const& __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::
  * \param[in]  p     relevant population (default = 0)
  * \return     requested linear population index after collision (writing)
 */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP> template <bool odd>
-inline auto& __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::AA_Write(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
-                                                                                   unsigned int const n,       unsigned int const d,       unsigned int const p)
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP> template <bool odd>
+inline auto& __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP,PROP>::AA_Write(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                                                                        unsigned int const n,       unsigned int const d,       unsigned int const p)
 {
     return F_[AA_IndexWrite<odd>(x,y,z,n,d,p)];
 }
 
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP> template <bool odd>
-inline auto const& __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::AA_Write(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
-                                                                                         unsigned int const n,       unsigned int const d,       unsigned int const p) const
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP> template <bool odd>
+inline auto const& __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP,PROP>::AA_Write(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                                                                              unsigned int const n,       unsigned int const d,       unsigned int const p) const
 {
     return F_[AA_IndexWrite<odd>(x,y,z,n,d,p)];
 }
 
+
+/**\fn         StreamCell
+ * \brief      Copy the populations of a cell after collision to the lattice with non-temporal stores
+ *             that bypass the cache and fill complete cache lines
+ * \warning    Inline function! The stores have to be ordered by a call of Fence.
+ *
+ * \tparam     CELL_SIZE   size of the populations of the cell in byte
+ * \param[out] cell        first population of the cell in the lattice
+ * \param[in]  post        cache-line aligned populations of the cell after collision (padding zero)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP> template <size_t CELL_SIZE>
+inline void __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP,PROP>::StreamCell(char* const cell, char const* const post)
+{
+    // widest stream that is aligned with every cell of the lattice
+    #if defined(__AVX__)
+        if constexpr (CELL_SIZE % sizeof(__m256i) == 0)
+        {
+            #pragma GCC unroll (8)
+            for(unsigned int i = 0; i < CELL_SIZE; i += sizeof(__m256i))
+            {
+                _mm256_stream_si256(reinterpret_cast<__m256i*>(cell + i), _mm256_load_si256(reinterpret_cast<__m256i const*>(post + i)));
+            }
+            return;
+        }
+    #endif
+    #if defined(__SSE2__)
+        if constexpr (CELL_SIZE % sizeof(__m128i) == 0)
+        {
+            #pragma GCC unroll (16)
+            for(unsigned int i = 0; i < CELL_SIZE; i += sizeof(__m128i))
+            {
+                _mm_stream_si128(reinterpret_cast<__m128i*>(cell + i), _mm_load_si128(reinterpret_cast<__m128i const*>(post + i)));
+            }
+            return;
+        }
+        else
+        {
+            #pragma GCC unroll (32)
+            for(unsigned int i = 0; i < CELL_SIZE; i += sizeof(int))
+            {
+                int value;
+                memcpy(&value, post + i, sizeof(int));
+                _mm_stream_si32(reinterpret_cast<int*>(cell + i), value);
+            }
+            return;
+        }
+    #endif
+
+    memcpy(cell, post, CELL_SIZE);
+}
+
+/**\fn         WriteCell
+ * \brief      Write all populations of a cell after collision depending on even and odd time step.
+ *             Propagation patterns that write the populations of a cell contiguously to the cell
+ *             itself stream the entire cell including its padding with non-temporal stores (see
+ *             StreamCell).
+ *             A single one of several interleaved populations (NPOP > 1) is written with regular stores.
+ * \warning    Inline function! Non-temporal stores have to be ordered by a call of Fence before the
+ *             populations are read by another thread.
+ *
+ * \tparam     odd   even (0, false) or odd (1, true) time step
+ * \param[in]  x     x coordinates of current cell and its neighbours [x-1,x,x+1]
+ * \param[in]  y     y coordinates of current cell and its neighbours [y-1,y,y+1]
+ * \param[in]  z     z coordinates of current cell and its neighbours [z-1,z,z+1]
+ * \param[in]  f     cache-line aligned populations of the cell after collision (padding zero)
+ * \param[in]  p     relevant population (default = 0)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP> template <bool odd>
+inline void __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP,PROP>::WriteCell(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                                                                         T const (&f)[LT::ND],   unsigned int const p)
+{
+    if constexpr ((PROP::NON_TEMPORAL == true) && (NPOP == 1))
+    {
+        StreamCell<sizeof(T)*LT::ND>(reinterpret_cast<char*>(F_ + AA_IndexWrite<odd>(x,y,z,0,0,p)), reinterpret_cast<char const*>(f));
+    }
+    else
+    {
+        #pragma GCC unroll (2)
+        for(unsigned int n = 0; n <= 1; ++n)
+        {
+            #pragma GCC unroll (16)
+            for(unsigned int d = n; d < LT::HSPEED; ++d)
+            {
+                F_[AA_IndexWrite<odd>(x,y,z,n,d,p)] = f[n*LT::OFF + d];
+            }
+        }
+    }
+}
+
+/**\fn         WriteCell
+ * \brief      Write the interleaved populations of all NPOP populations of a cell after collision
+ *             depending on even and odd time step. The entire cell is streamed with non-temporal
+ *             stores if the propagation pattern writes it contiguously to the cell itself, else one
+ *             index is evaluated per lattice velocity and the populations are stored contiguously.
+ * \warning    Inline function! Non-temporal stores have to be ordered by a call of Fence before the
+ *             populations are read by another thread.
+ *
+ * \tparam     odd   even (0, false) or odd (1, true) time step
+ * \param[in]  x     x coordinates of current cell and its neighbours [x-1,x,x+1]
+ * \param[in]  y     y coordinates of current cell and its neighbours [y-1,y,y+1]
+ * \param[in]  z     z coordinates of current cell and its neighbours [z-1,z,z+1]
+ * \param[in]  f     cache-line aligned populations of all populations of the cell after collision
+ *                   (padding zero)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP> template <bool odd>
+inline void __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP,PROP>::WriteCell(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                                                                         T const (&f)[LT::ND][NPOP])
+{
+    if constexpr (PROP::NON_TEMPORAL == true)
+    {
+        StreamCell<sizeof(T)*LT::ND*NPOP>(reinterpret_cast<char*>(F_ + AA_IndexWrite<odd>(x,y,z,0,0,0)), reinterpret_cast<char const*>(f));
+    }
+    else
+    {
+        #pragma GCC unroll (2)
+        for(unsigned int n = 0; n <= 1; ++n)
+        {
+            #pragma GCC unroll (16)
+            for(unsigned int d = n; d < LT::HSPEED; ++d)
+            {
+                T* const dst = F_ + AA_IndexWrite<odd>(x,y,z,n,d,0);
+
+                #pragma omp simd
+                for(unsigned int p = 0; p < NPOP; ++p)
+                {
+                    dst[p] = f[n*LT::OFF + d][p];
+                }
+            }
+        }
+    }
+}
+
+/**\fn         Fence
+ * \brief      Make the non-temporal stores of WriteCell of the calling thread globally visible
+ * \warning    Has to be called by every thread of the kernels after its last loop block of the time step.
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP>
+inline void __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP,PROP>::Fence() const
+{
+    #if defined(__SSE2__)
+        if constexpr (PROP::NON_TEMPORAL == true)
+        {
+            _mm_sfence();
+        }
+    #endif
+}
+
 #endif // POPULATION_INDEXING_HPP_INCLUDED
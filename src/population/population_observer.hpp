@@ -0,0 +1,379 @@
+#ifndef POPULATION_OBSERVER_HPP_INCLUDED
+#define POPULATION_OBSERVER_HPP_INCLUDED
+
+/**
+ * \file     population_observer.hpp
+ * \brief    High-frequency sampling of macroscopic values at probes, lines, planes and boxes
+ *
+ * \mainpage Full-field exports are too large to be written every time step. An observer samples
+ *           density and velocities only at registered cells directly from the populations (no
+ *           continuum has to be saved) and buffers the samples of several time steps before
+ *           writing them to a binary file.
+ *           Output:  OUTPUT_BIN_PATH/<name>.obs       records of [uint64 step, (rho,u,v,w) per cell]
+ *                    OUTPUT_BIN_PATH/<name>_index.txt  registered groups with their position in a record
+ *           The file extension differs from the full-field exports so that they are not picked up by
+ *           the converter.
+*/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../general/paths.hpp"
+#include "population.hpp"
+
+
+/**\class  Observer
+ * \brief  Samples macroscopic values of a population at registered cells and buffers them
+ *
+ * \tparam NX     simulation domain resolution in x-direction
+ * \tparam NY     simulation domain resolution in y-direction
+ * \tparam NZ     simulation domain resolution in z-direction
+ * \tparam LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam NPOP   number of populations stored side by side in the lattice
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP = 1>
+class Observer
+{
+    public:
+        /// import current lattice floating data type
+        typedef typename std::remove_const<decltype(LT::CS)>::type T;
+
+        static constexpr unsigned int NM_ = 4; ///< number of sampled values per cell: rho, ux, uy, uz
+
+    private:
+        Population<NX,NY,NZ,LT,NPOP> const& pop_;
+
+        std::string  const name_;       ///< name of the output files
+        unsigned int const interval_;   ///< number of time steps between two samples
+        unsigned int const capacity_;   ///< number of samples held in the buffer
+        unsigned int const p_;          ///< relevant population
+
+        std::vector<unsigned int> x_;   ///< coordinates of all registered cells
+        std::vector<unsigned int> y_;
+        std::vector<unsigned int> z_;
+        std::vector<std::string>  groups_; ///< description of all registered groups
+
+        std::vector<T> buffer_;         ///< buffered samples: [rho,u,v,w] per cell
+        std::vector<uint64_t> steps_;   ///< time steps of the buffered samples
+        FILE* file_;                    ///< output file (opened with the first sample)
+
+        /**\fn        Register
+         * \brief     Register a group of cells for sampling
+         *
+         * \param[in] type         type of the group
+         * \param[in] parameters   parameters describing the group
+         * \param[in] NA           number of cells in first direction
+         * \param[in] NB           number of cells in second direction
+         * \param[in] NC           number of cells in third direction
+         * \param[in] cell         function returning the coordinates of a cell of the group
+        */
+        template <typename Cell>
+        void Register(std::string const& type, std::string const& parameters, unsigned int const NA, unsigned int const NB, unsigned int const NC, Cell const& cell)
+        {
+            if ((file_ != nullptr) || (steps_.empty() == false))
+            {
+                std::cerr << "Fatal error: Observer '" << name_ << "' can't register cells after sampling started." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+
+            groups_.push_back(type + " " + std::to_string(x_.size()) + " " + std::to_string(NA) + " " +
+                              std::to_string(NB) + " " + std::to_string(NC) + " " + parameters);
+
+            for(unsigned int c = 0; c < NC; ++c)
+            {
+                for(unsigned int b = 0; b < NB; ++b)
+                {
+                    for(unsigned int a = 0; a < NA; ++a)
+                    {
+                        unsigned int x = 0;
+                        unsigned int y = 0;
+                        unsigned int z = 0;
+                        cell(a, b, c, x, y, z);
+
+                        if ((x >= NX) || (y >= NY) || (z >= NZ))
+                        {
+                            std::cerr << "Fatal error: Observer cell (" << x << ", " << y << ", " << z << ") outside domain." << std::endl;
+                            exit(EXIT_FAILURE);
+                        }
+                        x_.push_back(x);
+                        y_.push_back(y);
+                        z_.push_back(z);
+                    }
+                }
+            }
+        }
+
+        /**\fn    Open
+         * \brief Create output file and write index of registered groups
+        */
+        void Open()
+        {
+            struct stat info;
+
+            if (stat(OUTPUT_BIN_PATH.c_str(), &info) != 0 || !S_ISDIR(info.st_mode))
+            {
+                std::cerr << "Fatal error: Directory '" << OUTPUT_BIN_PATH << "' not found." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+
+            std::string const indexName = OUTPUT_BIN_PATH + std::string("/") + name_ + std::string("_index.txt");
+            FILE* const indexFile = fopen(indexName.c_str(), "w");
+            if (indexFile == nullptr)
+            {
+                std::cerr << "Fatal error: Could not create '" << indexName << "'." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            fprintf(indexFile, "cells %zu\n", x_.size());
+            fprintf(indexFile, "values %u\n", NM_);
+            fprintf(indexFile, "precision %zu\n", sizeof(T));
+            fprintf(indexFile, "interval %u\n", interval_);
+            fprintf(indexFile, "# type offset NA NB NC parameters\n");
+            for(size_t g = 0; g < groups_.size(); ++g)
+            {
+                fprintf(indexFile, "%s\n", groups_[g].c_str());
+            }
+            fclose(indexFile);
+
+            std::string const fileName = OUTPUT_BIN_PATH + std::string("/") + name_ + std::string(".obs");
+            file_ = fopen(fileName.c_str(), "wb");
+            if (file_ == nullptr)
+            {
+                std::cerr << "Fatal error: Could not create '" << fileName << "'." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+
+    public:
+        /**\brief     Class constructor
+         *
+         * \param[in] pop        population object holding microscopic variables
+         * \param[in] name       name of the output files
+         * \param[in] interval   number of time steps between two samples (default = 1)
+         * \param[in] capacity   number of samples that are buffered before writing (default = 256)
+         * \param[in] p          relevant population (default = 0)
+        */
+        Observer(Population<NX,NY,NZ,LT,NPOP> const& pop, std::string const& name, unsigned int const interval = 1,
+                 unsigned int const capacity = 256, unsigned int const p = 0):
+            pop_(pop), name_(name), interval_(std::max(interval, 1u)), capacity_(std::max(capacity, 1u)), p_(p),
+            x_(), y_(), z_(), groups_(), buffer_(), steps_(), file_(nullptr)
+        {
+            return;
+        }
+
+        Observer(Observer const&) = delete;
+        Observer& operator= (Observer const&) = delete;
+
+        /**\brief Class destructor: writes remaining samples
+        */
+        ~Observer()
+        {
+            Flush();
+            if (file_ != nullptr)
+            {
+                fclose(file_);
+            }
+        }
+
+        /**\fn        AddPoint
+         * \brief     Register a single probe
+         *
+         * \param[in] x   x coordinate of the probe
+         * \param[in] y   y coordinate of the probe
+         * \param[in] z   z coordinate of the probe
+        */
+        void AddPoint(unsigned int const x, unsigned int const y, unsigned int const z)
+        {
+            Register("point", std::to_string(x) + " " + std::to_string(y) + " " + std::to_string(z), 1, 1, 1,
+                     [=](unsigned int, unsigned int, unsigned int, unsigned int& x_c, unsigned int& y_c, unsigned int& z_c)
+                     { x_c = x; y_c = y; z_c = z; });
+        }
+
+        /**\fn        AddLine
+         * \brief     Register all cells along a straight line between two cells (inclusive)
+         *
+         * \param[in] start   coordinates of the first cell
+         * \param[in] end     coordinates of the last cell
+        */
+        void AddLine(std::array<unsigned int,3> const& start, std::array<unsigned int,3> const& end)
+        {
+            int const delta[3] = { static_cast<int>(end[0]) - static_cast<int>(start[0]),
+                                   static_cast<int>(end[1]) - static_cast<int>(start[1]),
+                                   static_cast<int>(end[2]) - static_cast<int>(start[2]) };
+            unsigned int const steps = std::max({std::abs(delta[0]), std::abs(delta[1]), std::abs(delta[2])});
+
+            std::string const parameters = std::to_string(start[0]) + " " + std::to_string(start[1]) + " " + std::to_string(start[2]) + " " +
+                                           std::to_string(end[0])   + " " + std::to_string(end[1])   + " " + std::to_string(end[2]);
+            Register("line", parameters, steps + 1, 1, 1,
+                     [=](unsigned int a, unsigned int, unsigned int, unsigned int& x_c, unsigned int& y_c, unsigned int& z_c)
+                     {
+                         double const s = (steps > 0) ? static_cast<double>(a)/steps : 0.0;
+                         x_c = static_cast<unsigned int>(std::lround(start[0] + s*delta[0]));
+                         y_c = static_cast<unsigned int>(std::lround(start[1] + s*delta[1]));
+                         z_c = static_cast<unsigned int>(std::lround(start[2] + s*delta[2]));
+                     });
+        }
+
+        /**\fn        AddPlane
+         * \brief     Register an entire plane normal to a coordinate axis
+         *
+         * \param[in] orientation   normal of the plane "x", "y" or "z"
+         * \param[in] position      position of the plane along its normal
+        */
+        void AddPlane(std::string const& orientation, unsigned int const position)
+        {
+            if (orientation == "x")
+            {
+                Register("plane", "x " + std::to_string(position), NY, NZ, 1,
+                         [=](unsigned int a, unsigned int b, unsigned int, unsigned int& x_c, unsigned int& y_c, unsigned int& z_c)
+                         { x_c = position; y_c = a; z_c = b; });
+            }
+            else if (orientation == "y")
+            {
+                Register("plane", "y " + std::to_string(position), NX, NZ, 1,
+                         [=](unsigned int a, unsigned int b, unsigned int, unsigned int& x_c, unsigned int& y_c, unsigned int& z_c)
+                         { x_c = a; y_c = position; z_c = b; });
+            }
+            else if (orientation == "z")
+            {
+                Register("plane", "z " + std::to_string(position), NX, NY, 1,
+                         [=](unsigned int a, unsigned int b, unsigned int, unsigned int& x_c, unsigned int& y_c, unsigned int& z_c)
+                         { x_c = a; y_c = b; z_c = position; });
+            }
+            else
+            {
+                std::cerr << "Fatal error: Plane orientation '" << orientation << "' not supported." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        /**\fn        AddBox
+         * \brief     Register all cells of an axis-aligned sub-volume
+         *
+         * \param[in] start   coordinates of the first corner (inclusive)
+         * \param[in] end     coordinates of the opposite corner (exclusive)
+        */
+        void AddBox(std::array<unsigned int,3> const& start, std::array<unsigned int,3> const& end)
+        {
+            std::string const parameters = std::to_string(start[0]) + " " + std::to_string(start[1]) + " " + std::to_string(start[2]) + " " +
+                                           std::to_string(end[0])   + " " + std::to_string(end[1])   + " " + std::to_string(end[2]);
+            Register("box", parameters,
+                     (end[0] > start[0]) ? end[0] - start[0] : 0,
+                     (end[1] > start[1]) ? end[1] - start[1] : 0,
+                     (end[2] > start[2]) ? end[2] - start[2] : 0,
+                     [=](unsigned int a, unsigned int b, unsigned int c, unsigned int& x_c, unsigned int& y_c, unsigned int& z_c)
+                     { x_c = start[0] + a; y_c = start[1] + b; z_c = start[2] + c; });
+        }
+
+        /**\fn        Sample
+         * \brief     Sample density and velocities at all registered cells if the time step is a
+         *            multiple of the interval. Has to be called between two time steps.
+         *
+         * \tparam    odd    parity of the following time step: even (0, false) or odd (1, true)
+         * \param[in] step   number of completed time steps
+        */
+        template <bool odd>
+        void Sample(size_t const step)
+        {
+            if ((step % interval_ != 0) || (x_.empty() == true))
+            {
+                return;
+            }
+
+            size_t const cells = x_.size();
+            size_t const start = buffer_.size();
+            if (start == 0)
+            {
+                buffer_.reserve(capacity_*cells*NM_);
+            }
+            buffer_.resize(start + cells*NM_);
+            steps_.push_back(step);
+
+            T* const sample = buffer_.data() + start;
+            unsigned int const p = p_;
+
+            Population<NX,NY,NZ,LT,NPOP> const& pop = pop_;
+            unsigned int const* const x = x_.data();
+            unsigned int const* const y = y_.data();
+            unsigned int const* const z = z_.data();
+
+            #pragma omp parallel for if(cells > 1024) default(none) shared(pop) firstprivate(sample,cells,p,x,y,z) schedule(static)
+            for(size_t i = 0; i < cells; ++i)
+            {
+                unsigned int const x_n[3] = { (NX + x[i] - 1) % NX, x[i], (x[i] + 1) % NX };
+                unsigned int const y_n[3] = { (NY + y[i] - 1) % NY, y[i], (y[i] + 1) % NY };
+                unsigned int const z_n[3] = { (NZ + z[i] - 1) % NZ, z[i], (z[i] + 1) % NZ };
+
+                T rho = 0.0;
+                T u   = 0.0;
+                T v   = 0.0;
+                T w   = 0.0;
+
+                #pragma GCC unroll (2)
+                for(unsigned int n = 0; n <= 1; ++n)
+                {
+                    #pragma GCC unroll (16)
+                    for(unsigned int d = n; d < LT::HSPEED; ++d)
+                    {
+                        unsigned int const curr = n*LT::OFF + d;
+                        T const f = pop.F_[pop. template AA_IndexRead<odd>(x_n,y_n,z_n,n,d,p)];
+                        rho += f;
+                        u   += f*LT::DX[curr];
+                        v   += f*LT::DY[curr];
+                        w   += f*LT::DZ[curr];
+                    }
+                }
+
+                sample[i*NM_ + 0] = rho;
+                sample[i*NM_ + 1] = u/rho;
+                sample[i*NM_ + 2] = v/rho;
+                sample[i*NM_ + 3] = w/rho;
+            }
+
+            if (steps_.size() >= capacity_)
+            {
+                Flush();
+            }
+        }
+
+        /**\fn    Flush
+         * \brief Write all buffered samples to disk
+        */
+        void Flush()
+        {
+            if (steps_.empty() == true)
+            {
+                return;
+            }
+            if (file_ == nullptr)
+            {
+                Open();
+            }
+
+            size_t const values = x_.size()*NM_;
+            for(size_t s = 0; s < steps_.size(); ++s)
+            {
+                if ((fwrite(&steps_[s], sizeof(uint64_t), 1, file_) != 1) ||
+                    (fwrite(buffer_.data() + s*values, sizeof(T), values, file_) != values))
+                {
+                    std::cerr << "Fatal error: Could not write observer '" << name_ << "'." << std::endl;
+                    exit(EXIT_FAILURE);
+                }
+            }
+            fflush(file_);
+
+            buffer_.clear();
+            steps_.clear();
+        }
+};
+
+#endif // POPULATION_OBSERVER_HPP_INCLUDED
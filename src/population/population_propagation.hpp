@@ -0,0 +1,146 @@
+#ifndef POPULATION_PROPAGATION_HPP_INCLUDED
+#define POPULATION_PROPAGATION_HPP_INCLUDED
+
+/**
+ * \file     population_propagation.hpp
+ * \mainpage Propagation patterns: where the populations of a cell are read before and written after
+ *           collision in even and odd time steps
+ *
+ * \note     The kernels and the indexing functions of the population (AA_IndexRead, AA_IndexWrite)
+ *           are independent of the propagation pattern, it is selected by the template parameter
+ *           PROP of the population. Every pattern maps a population (n,d) of the current cell to the
+ *           neighbour it is stored in ([x-1,x,x+1] given by 0,1,2), its slot (positive or negative
+ *           half) and the lattice.
+ * \warning  The boundary conditions with precomputed population indices (boundary lists and links)
+ *           are restricted to the A-A pattern.
+*/
+
+
+namespace propagation
+{
+    /**\class  Access
+     * \brief  Location of a population: neighbour cell, slot and lattice
+    */
+    class Access
+    {
+        public:
+            unsigned int x;         ///< neighbour in x-direction: 0 (x-1), 1 (x) or 2 (x+1)
+            unsigned int y;         ///< neighbour in y-direction
+            unsigned int z;         ///< neighbour in z-direction
+            unsigned int n;         ///< slot: positive (0) or negative (1) half
+            unsigned int lattice;   ///< lattice the population is stored in
+    };
+
+    /**\fn        Neighbour
+     * \brief     Neighbour index [x-1,x,x+1] given by 0,1,2 in direction of a lattice velocity component
+     *
+     * \param[in] c   lattice velocity component
+     * \return    Index of the neighbour in the coordinate arrays of the kernels
+    */
+    template <typename T>
+    constexpr unsigned int Neighbour(T const c)
+    {
+        return static_cast<unsigned int>(1 + static_cast<int>(c));
+    }
+
+    /**\class  AA
+     * \brief  A-A access pattern: even time steps are local with swapped slots, odd time steps read
+     *         from and write to the neighbours
+     * \note   "Accelerating Lattice Boltzmann Fluid Flow Simulations Using Graphics Processors"
+     *         P. Bailey, J. Myre, S.D.C. Walsh, D.J. Lilja, M.O. Saar
+     *         38th International Conference on Parallel Processing (ICPP), Vienna, Austria (2009)
+     *         DOI: 10.1109/ICPP.2009.38
+    */
+    class AA
+    {
+        public:
+            static constexpr unsigned int LATTICES = 1;         ///< number of lattices
+            static constexpr bool     NON_TEMPORAL = false;     ///< cells are written contiguously to themselves with non-temporal stores
+
+            template <bool odd, class LT>
+            static constexpr Access Read(unsigned int const n, unsigned int const d)
+            {
+                return { odd ? Neighbour(LT::DX[!n*LT::OFF+d]) : 1,
+                         odd ? Neighbour(LT::DY[!n*LT::OFF+d]) : 1,
+                         odd ? Neighbour(LT::DZ[!n*LT::OFF+d]) : 1,
+                         odd ? n : !n, 0 };
+            }
+
+            template <bool odd, class LT>
+            static constexpr Access Write(unsigned int const n, unsigned int const d)
+            {
+                return { odd ? Neighbour(LT::DX[n*LT::OFF+d]) : 1,
+                         odd ? Neighbour(LT::DY[n*LT::OFF+d]) : 1,
+                         odd ? Neighbour(LT::DZ[n*LT::OFF+d]) : 1,
+                         odd ? !n : n, 0 };
+            }
+    };
+
+    /**\class  EsotericTwist
+     * \brief  In-place esoteric twist: every component of a lattice velocity pointing in negative
+     *         direction is read from the neighbour and every positive one is written to the neighbour,
+     *         the slots are swapped between reading and writing. Even and odd time steps only differ
+     *         in the slots, the access is half local and half non-local in both.
+     * \note   "Esoteric Twist: An Efficient in-Place Streaming Algorithmus for the Lattice Boltzmann
+     *         Method on Massively Parallel Hardware"
+     *         M. Geier, M. Schoenherr
+     *         Computation 5 (2017)
+     *         DOI: 10.3390/computation5020019
+    */
+    class EsotericTwist
+    {
+        public:
+            static constexpr unsigned int LATTICES = 1;
+            static constexpr bool     NON_TEMPORAL = false;
+
+            template <bool odd, class LT>
+            static constexpr Access Read(unsigned int const n, unsigned int const d)
+            {
+                return { (LT::DX[n*LT::OFF+d] < 0) ? Neighbour(-LT::DX[n*LT::OFF+d]) : 1,
+                         (LT::DY[n*LT::OFF+d] < 0) ? Neighbour(-LT::DY[n*LT::OFF+d]) : 1,
+                         (LT::DZ[n*LT::OFF+d] < 0) ? Neighbour(-LT::DZ[n*LT::OFF+d]) : 1,
+                         odd ? !n : n, 0 };
+            }
+
+            template <bool odd, class LT>
+            static constexpr Access Write(unsigned int const n, unsigned int const d)
+            {
+                return { (LT::DX[n*LT::OFF+d] > 0) ? Neighbour(LT::DX[n*LT::OFF+d]) : 1,
+                         (LT::DY[n*LT::OFF+d] > 0) ? Neighbour(LT::DY[n*LT::OFF+d]) : 1,
+                         (LT::DZ[n*LT::OFF+d] > 0) ? Neighbour(LT::DZ[n*LT::OFF+d]) : 1,
+                         odd ? n : !n, 0 };
+            }
+    };
+
+    /**\class  AB
+     * \brief  Classic two-lattice pull pattern: the populations are pulled from the neighbours in
+     *         lattice A and written to the cell itself in lattice B in even time steps and vice versa
+     *         in odd ones. All populations of a cell are written contiguously which allows for
+     *         non-temporal stores that bypass the cache and avoid the read-for-ownership of the
+     *         destination lattice.
+     * \warning Requires twice the memory.
+    */
+    class AB
+    {
+        public:
+            static constexpr unsigned int LATTICES = 2;
+            static constexpr bool     NON_TEMPORAL = true;
+
+            template <bool odd, class LT>
+            static constexpr Access Read(unsigned int const n, unsigned int const d)
+            {
+                return { Neighbour(LT::DX[!n*LT::OFF+d]),
+                         Neighbour(LT::DY[!n*LT::OFF+d]),
+                         Neighbour(LT::DZ[!n*LT::OFF+d]),
+                         n, odd ? 1u : 0u };
+            }
+
+            template <bool odd, class LT>
+            static constexpr Access Write(unsigned int const n, [[maybe_unused]] unsigned int const d)
+            {
+                return { 1, 1, 1, n, odd ? 0u : 1u };
+            }
+    };
+}
+
+#endif // POPULATION_PROPAGATION_HPP_INCLUDED
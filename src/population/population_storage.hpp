@@ -0,0 +1,190 @@
+#ifndef POPULATION_STORAGE_HPP_INCLUDED
+#define POPULATION_STORAGE_HPP_INCLUDED
+
+/**
+ * \file     population_storage.hpp
+ * \mainpage Class members for allocating the populations in main memory or out-of-core
+ *
+ * \note     For lattices larger than main memory the populations can be backed by a file that is
+ *           mapped to memory. The operating system then only holds the recently used pages in
+ *           memory. In order to keep the accesses local the collide-stream kernels are swept slab by
+ *           slab in z-direction (one slab corresponds to a layer of loop blocks): while the current
+ *           slab is processed the next one is read ahead asynchronously and the write-back of the
+ *           previous one is started and its pages are released, overlapping the I/O with computation.
+ *           Due to the A-A access pattern every time step is performed in-place and the population
+ *           of a cell is only accessed by the cell itself and its direct neighbours, therefore only
+ *           about two slabs have to be held in memory. Propagation patterns with two lattices read
+ *           ahead and release the slab in both of them.
+ * \warning  The throughput is bounded by the bandwidth of the underlying storage.
+*/
+
+#include <algorithm>
+#include <fcntl.h>
+#include <iostream>
+#include <stdlib.h>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "../general/memory_alignment.hpp"
+
+
+/**\fn        Allocate
+ * \brief     Allocate the populations either aligned in main memory or mapped from a file
+ *
+ * \param[in] storage   file backing the populations (empty: main memory)
+ * \return    Pointer to the populations or nullptr if they could not be allocated
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP>
+typename Population<NX,NY,NZ,LT,NPOP,PROP>::T* Population<NX,NY,NZ,LT,NPOP,PROP>::Allocate(std::string const& storage)
+{
+    if (storage.empty() == true)
+    {
+        return static_cast<T*>(aligned_alloc(CACHE_LINE, MEM_SIZE_));
+    }
+
+    storage_ = open(storage.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if ((storage_ < 0) || (ftruncate(storage_, MEM_SIZE_) != 0))
+    {
+        std::cerr << "Fatal error: Could not create population storage '" << storage << "'." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    void* const file = mmap(nullptr, MEM_SIZE_, PROT_READ | PROT_WRITE, MAP_SHARED, storage_, 0);
+    if (file == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    // accesses are local within a slab: no read-ahead across the entire file
+    madvise(file, MEM_SIZE_, MADV_RANDOM);
+
+    return static_cast<T*>(file);
+}
+
+/**\fn    Deallocate
+ * \brief Free the populations or unmap them from the backing file
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP>
+void Population<NX,NY,NZ,LT,NPOP,PROP>::Deallocate()
+{
+    if (storage_ < 0)
+    {
+        free(F_);
+    }
+    else
+    {
+        munmap(F_, MEM_SIZE_);
+        close(storage_);
+        storage_ = -1;
+    }
+}
+
+/**\fn        SlabRange
+ * \brief     Page-aligned byte range of the populations of a slab of loop blocks in z-direction
+ *
+ * \param[in]  slab      index of the slab (loop block in z-direction)
+ * \param[in]  lattice   lattice of propagation patterns with several lattices
+ * \param[out] begin     first byte of the slab
+ * \param[out] end       byte after the last one of the slab
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP>
+void SlabRange(Population<NX,NY,NZ,LT,NPOP,PROP> const& pop, unsigned int const slab, unsigned int const lattice,
+               size_t& begin, size_t& end)
+{
+    size_t const   page = sysconf(_SC_PAGESIZE);
+    size_t const    cut = sizeof(typename Population<NX,NY,NZ,LT,NPOP,PROP>::T)*NX*NY*NPOP*static_cast<size_t>(LT::ND);
+    size_t const offset = sizeof(typename Population<NX,NY,NZ,LT,NPOP,PROP>::T)*pop.LATTICE_SIZE_*lattice;
+
+    unsigned int const z_start = std::min(pop.BLOCK_SIZE_*slab, NZ);
+    unsigned int const   z_end = std::min(z_start + pop.BLOCK_SIZE_, NZ);
+
+    begin = ((offset + cut*z_start) / page)*page;
+    end   = std::min(((offset + cut*z_end + page - 1) / page)*page, pop.MEM_SIZE_);
+}
+
+/**\fn        PrefetchSlab
+ * \brief     Asynchronously read ahead a slab of an out-of-core population
+ *
+ * \param[in] slab   index of the slab (loop block in z-direction)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP>
+void Population<NX,NY,NZ,LT,NPOP,PROP>::PrefetchSlab(unsigned int const slab) const
+{
+    if ((storage_ < 0) || (slab >= NUM_BLOCKS_Z_))
+    {
+        return;
+    }
+
+    for(unsigned int lattice = 0; lattice < PROP::LATTICES; ++lattice)
+    {
+        size_t begin = 0;
+        size_t   end = 0;
+        SlabRange(*this, slab, lattice, begin, end);
+        madvise(reinterpret_cast<char*>(F_) + begin, end - begin, MADV_WILLNEED);
+    }
+}
+
+/**\fn        ReleaseSlab
+ * \brief     Start the asynchronous write-back of a slab of an out-of-core population and release
+ *            its pages. Dirty pages are kept by the page cache until they are written to the file.
+ *
+ * \param[in] slab   index of the slab (loop block in z-direction)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP>
+void Population<NX,NY,NZ,LT,NPOP,PROP>::ReleaseSlab(unsigned int const slab) const
+{
+    if ((storage_ < 0) || (slab >= NUM_BLOCKS_Z_))
+    {
+        return;
+    }
+
+    for(unsigned int lattice = 0; lattice < PROP::LATTICES; ++lattice)
+    {
+        size_t begin = 0;
+        size_t   end = 0;
+        SlabRange(*this, slab, lattice, begin, end);
+        #ifdef SYNC_FILE_RANGE_WRITE
+            sync_file_range(storage_, begin, end - begin, SYNC_FILE_RANGE_WRITE);
+        #else
+            msync(reinterpret_cast<char*>(F_) + begin, end - begin, MS_ASYNC);
+        #endif
+        madvise(reinterpret_cast<char*>(F_) + begin, end - begin, MADV_DONTNEED);
+    }
+}
+
+/**\fn        SweepSlabs
+ * \brief     Perform a kernel over the entire domain. For populations in main memory the kernel is
+ *            called once for all loop blocks, out-of-core it is called slab by slab in z-direction
+ *            with prefetch of the following and write-behind of the preceding slab.
+ *
+ * \tparam    Kernel   callable with the signature (unsigned int block_begin, unsigned int block_end)
+ * \param[in] kernel   kernel that processes the loop blocks [block_begin, block_end)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class PROP> template <typename Kernel>
+void Population<NX,NY,NZ,LT,NPOP,PROP>::SweepSlabs(Kernel const& kernel) const
+{
+    if (storage_ < 0)
+    {
+        kernel(0, NUM_BLOCKS_);
+        return;
+    }
+
+    constexpr unsigned int SLAB_BLOCKS = NUM_BLOCKS_X_*NUM_BLOCKS_Y_;
+
+    PrefetchSlab(0);
+    for(unsigned int slab = 0; slab < NUM_BLOCKS_Z_; ++slab)
+    {
+        PrefetchSlab(slab + 1);
+        kernel(slab*SLAB_BLOCKS, (slab + 1)*SLAB_BLOCKS);
+
+        // the preceding slab is not accessed anymore by the following ones
+        if (slab > 0)
+        {
+            ReleaseSlab(slab - 1);
+        }
+    }
+    ReleaseSlab(NUM_BLOCKS_Z_ - 1);
+}
+
+#endif // POPULATION_STORAGE_HPP_INCLUDED
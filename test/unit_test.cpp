@@ -0,0 +1,43 @@
+/**
+ * \file     unit_test.cpp
+ * \mainpage Unit tests of the solver components, run with 'make test' from the main directory
+ *           (the export directories output/bin/ and backup/ have to exist)
+*/
+
+#include <iostream>
+#include <stdlib.h>
+#include <string>
+
+#include "continuum/continuum_brick_unit_test.hpp"
+#include "population/boundary/boundary_immersed_unit_test.hpp"
+#include "population/boundary/boundary_wall_function_unit_test.hpp"
+#include "population/collision/collision_bgk_ensemble_unit_test.hpp"
+#include "population/population_backup_unit_test.hpp"
+
+
+/**\fn        Run
+ * \brief     Run a single unit test and report its result
+ *
+ * \param[in] name   name of the test
+ * \param[in] test   unit test returning EXIT_SUCCESS if it passed
+ * \return    Return 1 if the test failed, else 0
+*/
+unsigned int Run(std::string const& name, int (*test)())
+{
+    int const result = test();
+    std::cout << ((result == EXIT_SUCCESS) ? "Test passed: " : "Test FAILED: ") << name << std::endl;
+    return (result == EXIT_SUCCESS) ? 0 : 1;
+}
+
+int main()
+{
+    unsigned int failed = 0;
+    failed += Run("brick export round trip", UnitTestBricks);
+    failed += Run("population back-up round trip", UnitTestBackup);
+    failed += Run("immersed boundary drag", UnitTestImmersedBoundary);
+    failed += Run("wall function log law", UnitTestWallFunction);
+    failed += Run("ensemble against single-population BGK", UnitTestEnsemble);
+
+    std::cout << failed << " test(s) failed" << std::endl;
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}